@@ -91,6 +91,14 @@ def config_cache(options, system):
                                                       PageTableWalkerCache())
             else:
                 system.cpu[i].addPrivateSplitL1Caches(icache, dcache)
+
+            if options.warm_caches:
+                if options.l2cache:
+                    icache.warm_next = system.l2
+                    dcache.warm_next = system.l2
+                if isinstance(system.cpu[i], AtomicSimpleCPU):
+                    system.cpu[i].warm_icache = icache
+                    system.cpu[i].warm_dcache = dcache
         system.cpu[i].createInterruptController()
         if options.l2cache:
             system.cpu[i].connectAllPorts(system.tol2bus, system.membus)
@@ -191,6 +191,9 @@ def addCommonOptions(parser):
     parser.add_option("-F", "--fast-forward", action="store", type="string",
         default=None,
         help="Number of instructions to fast forward before switching")
+    parser.add_option("--warm-caches", action="store_true", default=False,
+        help="""Warm the caches while fast forwarding, updating only their
+                tags (requires --fast-forward and --caches)""")
     parser.add_option("-S", "--simpoint", action="store_true", default=False,
         help="""Use workload simpoints as an instruction offset for
                 --checkpoint-restore or --take-checkpoint.""")
@@ -82,6 +82,9 @@ def setCPUClass(options):
         CPUClass = TmpClass
         TmpClass = AtomicSimpleCPU
         test_mem_mode = 'atomic'
+        if options.warm_caches:
+            # the CPU goes straight to memory and tells the caches
+            test_mem_mode = 'atomic_noncaching'
 
     return (TmpClass, test_mem_mode, CPUClass)
 
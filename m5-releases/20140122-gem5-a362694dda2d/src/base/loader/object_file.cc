@@ -126,6 +126,11 @@ createObjectFile(const string &fname, bool raw)
         return NULL;
     }
 
+    // readahead hint: the kernel starts reading the image while the
+    // rest of the system is built, so the page faults of loading it
+    // later are cheaper; processes are still loaded one at a time
+    madvise(fileData, len, MADV_WILLNEED);
+
     ObjectFile *fileObj = NULL;
 
     // figure out what we have here
@@ -130,6 +130,9 @@ class ObjectFile
     size_t dataSize() const { return data.size; }
     size_t bssSize() const { return bss.size; }
 
+    /** The file image of the text section, or NULL if there is none. */
+    const uint8_t *textImage() const { return text.fileImage; }
+
     /* This function allows you to override the base address where
      * a binary is going to be loaded or set it if the binary is just a
      * blob that doesn't include an object header.
@@ -84,6 +84,7 @@ OutputDirectory::openFile(const string &filename,
             fatal("Cannot open file %s", filename);
         assert(files.find(filename) == files.end());
         files[filename] = file;
+        modes[file] = mode;
         return file;
     } else {
         ofstream *file = new ofstream(filename.c_str(), mode);
@@ -91,6 +92,7 @@ OutputDirectory::openFile(const string &filename,
             fatal("Cannot open file %s", filename);
         assert(files.find(filename) == files.end());
         files[filename] = file;
+        modes[file] = mode;
         return file;
     }
 }
@@ -120,6 +122,7 @@ OutputDirectory::close(ostream *openStream) {
     if (i == files.end())
         fatal("Attempted to close an unregistred file stream");
 
+    modes.erase(openStream);
     files.erase(i);
 }
 
@@ -136,6 +139,65 @@ OutputDirectory::setDirectory(const string &d)
         dir += PATH_SEPARATOR;
 }
 
+void
+OutputDirectory::redirect(const string &d)
+{
+    if (dir.empty())
+        panic("Output directory not set!\n");
+
+    string old_dir = dir;
+    dir = d;
+    if (dir[dir.size() - 1] != PATH_SEPARATOR)
+        dir += PATH_SEPARATOR;
+
+    if ((mkdir(dir.c_str(), 0755) != 0) && (errno != EEXIST))
+        fatal("Failed to create new output directory '%s'\n", dir);
+
+    map_t moved;
+    for (map_t::iterator i = files.begin(); i != files.end(); ++i) {
+        // files given by absolute path stay where they are
+        if (i->first.compare(0, old_dir.size(), old_dir) != 0) {
+            moved.insert(*i);
+            continue;
+        }
+
+        string filename = dir + i->first.substr(old_dir.size());
+        ofstream *fs = dynamic_cast<ofstream*>(i->second);
+        if (fs) {
+            // the file starts over, but stays binary if it was
+            ios_base::openmode mode = ios::trunc | (modes[fs] & ios::binary);
+            fs->close();
+            fs->open(filename.c_str(), mode);
+            if (!fs->is_open())
+                fatal("Cannot open file %s", filename);
+            moved[filename] = fs;
+        } else {
+            // closing or deleting the stream would finish the
+            // compressed file of the old directory, so leave it open
+            // for its users and drop anything written to it
+            warn("Output to %s is discarded after moving to %s\n",
+                 i->first, dir);
+            i->second->setstate(ios::badbit);
+        }
+    }
+    files.swap(moved);
+
+    redirectCallbacks.process();
+}
+
+void
+OutputDirectory::addRedirectCallback(Callback *callback)
+{
+    redirectCallbacks.add(callback);
+}
+
+void
+OutputDirectory::flush()
+{
+    for (map_t::iterator i = files.begin(); i != files.end(); ++i)
+        i->second->flush();
+}
+
 const string &
 OutputDirectory::directory() const
 {
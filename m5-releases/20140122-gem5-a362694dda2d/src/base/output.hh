@@ -36,6 +36,8 @@
 #include <map>
 #include <string>
 
+#include "base/callback.hh"
+
 /** Interface for creating files in a gem5 output directory. */
 class OutputDirectory
 {
@@ -46,6 +48,12 @@ class OutputDirectory
     /** Open file streams within this directory */
     map_t files;
 
+    /** The modes the file streams were opened with */
+    std::map<const std::ostream *, std::ios_base::openmode> modes;
+
+    /** Callbacks to invoke after the directory moved */
+    CallbackQueue redirectCallbacks;
+
     /** Name of this directory */
     std::string dir;
 
@@ -97,6 +105,28 @@ class OutputDirectory
      */
     void setDirectory(const std::string &dir);
 
+    /**
+     * Moves this directory, e.g. in a process forked from the
+     * simulator. Open files are flushed away from the old directory
+     * and reopened, truncated, under the new one, so that streams
+     * handed out before stay valid. Compressed files cannot be
+     * reopened and discard further output.
+     *
+     * @param dir new name of this directory
+     */
+    void redirect(const std::string &dir);
+
+    /**
+     * Registers a callback to invoke after the directory moved, for
+     * writers that have to start their files over, e.g. with a header.
+     *
+     * @param callback callback to invoke on every redirect()
+     */
+    void addRedirectCallback(Callback *callback);
+
+    /** Flushes all open files. */
+    void flush();
+
     /**
      * Gets name of this directory.
      * @return name of this directory
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "base/callback.hh"
+#include "base/cprintf.hh"
+#include "base/misc.hh"
+#include "base/output.hh"
+#include "base/pool.hh"
+#include "sim/core.hh"
+
+using namespace std;
+
+namespace {
+
+/** Size of a slab in bytes, unless an object is larger */
+const size_t slabBytes = 64 * 1024;
+
+/** All pools, indexed by id; zero initialized before any constructor */
+Pool *pools[Pool::MaxPools];
+unsigned numPools;
+
+/**
+ * Guards the list of pools and the pool state of the threads. Pools
+ * may be created by any thread, e.g. as static locals.
+ */
+mutex poolsLock;
+
+/** The pool state of every thread that used a pool */
+vector<void *> &
+threads()
+{
+    static vector<void *> list;
+    return list;
+}
+
+struct PoolStatsCallback : public Callback
+{
+    void
+    process()
+    {
+        ostream *os = simout.create("pools.txt");
+        Pool::printStats(*os);
+        simout.close(os);
+    }
+};
+
+/** Add a pool to the list of pools and return its id. */
+unsigned
+registerPool(Pool *pool)
+{
+    lock_guard<mutex> lock(poolsLock);
+    if (numPools == Pool::MaxPools)
+        panic("Too many pools, increase Pool::MaxPools\n");
+    pools[numPools] = pool;
+    return numPools++;
+}
+
+size_t
+roundSize(size_t size)
+{
+    // keep every object aligned as malloc would
+    const size_t align = 16;
+    return (max(size, sizeof(void *)) + align - 1) & ~(align - 1);
+}
+
+} // anonymous namespace
+
+__thread Pool::Local *Pool::threadLocals = NULL;
+
+Pool::Pool(const char *name, size_t size)
+    : name(name), _size(roundSize(size)),
+      slabObjects(max(slabBytes / roundSize(size), (size_t)1)),
+      id(registerPool(this)), shared(NULL)
+{
+}
+
+Pool::Local *
+Pool::initThread()
+{
+    Local *l = new Local[MaxPools]();
+
+    lock_guard<mutex> lock(poolsLock);
+    if (threads().empty())
+        registerExitCallback(new PoolStatsCallback);
+    threads().push_back(l);
+
+    threadLocals = l;
+    return l;
+}
+
+void *
+Pool::refill(Local &l)
+{
+    // the whole shared list is taken at once, so popping cannot race
+    // with other threads taking it
+    void *p = shared.exchange(NULL);
+    if (p) {
+        l.free = *(void **)p;
+        for (void *q = l.free; q; q = *(void **)q)
+            ++l.numFree;
+        return p;
+    }
+
+    char *slab = static_cast<char *>(::operator new(slabObjects * _size));
+    ++l.slabs;
+
+    // hand out the first object, the rest go on the free list
+    for (size_t i = slabObjects - 1; i > 0; --i) {
+        void *p = slab + i * _size;
+        *(void **)p = l.free;
+        l.free = p;
+    }
+    l.numFree += slabObjects - 1;
+    return slab;
+}
+
+void
+Pool::spill(Local &l)
+{
+    void *head = l.free;
+    void *tail = head;
+    for (size_t i = 1; i < slabObjects; ++i)
+        tail = *(void **)tail;
+    l.free = *(void **)tail;
+    l.numFree -= slabObjects;
+
+    void *old = shared.load();
+    do {
+        *(void **)tail = old;
+    } while (!shared.compare_exchange_weak(old, head));
+}
+
+void
+Pool::printStats(ostream &os)
+{
+    lock_guard<mutex> lock(poolsLock);
+
+    ccprintf(os, "%-40s %8s %14s %10s %12s\n",
+             "pool", "size", "allocs", "live", "bytes");
+    for (unsigned i = 0; i < numPools; ++i) {
+        const Pool *pool = pools[i];
+        Counter allocs = 0, frees = 0, slabs = 0;
+        for (auto t = threads().begin(); t != threads().end(); ++t) {
+            const Local &l = static_cast<const Local *>(*t)[i];
+            allocs += l.allocs;
+            frees += l.frees;
+            slabs += l.slabs;
+        }
+        ccprintf(os, "%-40s %8d %14d %10d %12d\n", pool->name,
+                 pool->_size, allocs, allocs - frees,
+                 slabs * pool->slabObjects * pool->_size);
+    }
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_POOL_HH__
+#define __BASE_POOL_HH__
+
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+
+#include "base/types.hh"
+
+/**
+ * Slab allocator for objects of a single size that are created and
+ * destroyed at a high rate, such as packets. Memory is taken from the
+ * heap in slabs of many objects and freed objects are kept on a free
+ * list for reuse; it is never returned to the heap.
+ *
+ * Every thread has free lists of its own, so neither allocation nor
+ * deallocation takes a lock. An object freed by a thread other than
+ * the one that allocated it moves to the free list of the freeing
+ * thread. So that objects made on one thread and freed on another
+ * find their way back, a free list that grows beyond two slabs hands
+ * a slab worth of objects to a list shared by all threads, which is
+ * emptied before a new slab is taken from the heap.
+ *
+ * Pools are meant to be global objects. The number of allocations,
+ * the number of objects still live and the memory held by every pool
+ * are written to pools.txt in the output directory at exit.
+ */
+class Pool
+{
+  public:
+    /** Maximum number of pools in the simulator. */
+    static const unsigned MaxPools = 16;
+
+    /**
+     * @param name Name of the pool in the statistics
+     * @param size Object size in bytes
+     */
+    Pool(const char *name, size_t size);
+
+    void *
+    allocate()
+    {
+        Local &l = local();
+        ++l.allocs;
+        void *p = l.free;
+        if (!p)
+            return refill(l);
+        l.free = *(void **)p;
+        --l.numFree;
+        return p;
+    }
+
+    void
+    deallocate(void *p)
+    {
+        Local &l = local();
+        ++l.frees;
+        *(void **)p = l.free;
+        l.free = p;
+        if (++l.numFree > 2 * slabObjects)
+            spill(l);
+    }
+
+    /** Object size in bytes. */
+    size_t size() const { return _size; }
+
+    /** Write the statistics of all pools. */
+    static void printStats(std::ostream &os);
+
+  private:
+    /** The state of a pool in one thread. */
+    struct Local {
+        void *free;
+        /** Number of objects on the free list */
+        size_t numFree;
+        Counter allocs;
+        Counter frees;
+        Counter slabs;
+    };
+
+    Local &
+    local()
+    {
+        Local *l = threadLocals;
+        if (!l)
+            l = initThread();
+        return l[id];
+    }
+
+    /**
+     * Take the objects returned by other threads, or allocate a slab
+     * if there are none, and return the first object.
+     */
+    void *refill(Local &l);
+
+    /** Move a slab worth of free objects to the shared list. */
+    void spill(Local &l);
+
+    /** Create the pool state of the current thread. */
+    static Local *initThread();
+
+    const char *name;
+    const size_t _size;
+    /** Number of objects in a slab */
+    const size_t slabObjects;
+    /** Index of the pool in the state of each thread */
+    const unsigned id;
+
+    /** Free objects handed back by any thread */
+    std::atomic<void *> shared;
+
+    /** The state of all pools in the current thread */
+    static __thread Local *threadLocals;
+};
+
+#endif // __BASE_POOL_HH__
@@ -352,9 +352,132 @@ HistStor::grow_up()
     bucket_size *= 2;
 }
 
+void
+DistStor::flush()
+{
+    size_type n = batch.count;
+    batch.count = 0;
+
+    // Fold the samples in using locals, which the compiler cannot
+    // keep in registers across the bucket updates otherwise, and
+    // pick the counter to add to without branching, as whether a
+    // value falls in the buckets is hard to predict. The sums are
+    // still formed in sampling order, so the result is the same as
+    // sampling directly.
+    Counter outside[2] = { underflow, overflow };
+    Counter _min_val = min_val, _max_val = max_val;
+    Counter _sum = sum, _squares = squares, _samples = samples;
+    Counter last = size() - 1;
+    Counter *buckets = &cvec[0];
+
+    for (size_type i = 0; i < n; ++i) {
+        Counter val = batch.val[i];
+        Counter number = batch.number[i];
+
+        // values in range are not below min_track, so truncating
+        // is the same as rounding down, and values out of range are
+        // clamped to a valid index before their counter is picked
+        Counter pos = (val - min_track) / bucket_size;
+        pos = std::max(Counter(), std::min(pos, last));
+        Counter *counter = &buckets[(size_type)pos];
+        counter = val < min_track ? &outside[0] : counter;
+        counter = val > max_track ? &outside[1] : counter;
+        *counter += number;
+
+        _min_val = std::min(val, _min_val);
+        _max_val = std::max(val, _max_val);
+
+        _sum += val * number;
+        _squares += val * val * number;
+        _samples += number;
+    }
+
+    underflow = outside[0];
+    overflow = outside[1];
+    min_val = _min_val;
+    max_val = _max_val;
+    sum = _sum;
+    squares = _squares;
+    samples = _samples;
+}
+
+void
+HistStor::grow(Counter val)
+{
+    if (val < min_bucket) {
+        if (min_bucket == 0)
+            grow_convert();
+
+        while (val < min_bucket)
+            grow_out();
+    } else if (val >= max_bucket + bucket_size) {
+        if (min_bucket == 0) {
+            while (val >= max_bucket + bucket_size)
+                grow_up();
+        } else {
+            while (val >= max_bucket + bucket_size)
+                grow_out();
+        }
+    }
+}
+
+void
+HistStor::fold(size_type begin, size_type end)
+{
+    Counter _sum = sum, _squares = squares, _logs = logs;
+    Counter _samples = samples;
+    Counter *buckets = &cvec[0];
+
+    for (size_type i = begin; i < end; ++i) {
+        Counter val = batch.val[i];
+        Counter number = batch.number[i];
+
+        // the buckets cover the value, so truncating is the same as
+        // rounding down
+        size_type index = (size_type)((val - min_bucket) / bucket_size);
+        assert(index < size());
+        buckets[index] += number;
+
+        _sum += val * number;
+        _squares += val * val * number;
+        _logs += log(val) * number;
+        _samples += number;
+    }
+
+    sum = _sum;
+    squares = _squares;
+    logs = _logs;
+    samples = _samples;
+}
+
+void
+HistStor::flush()
+{
+    assert(min_bucket < max_bucket);
+
+    size_type n = batch.count;
+    batch.count = 0;
+
+    // fold in what has been sampled before every rescale, so that
+    // each sample is counted with the buckets it would have seen
+    size_type begin = 0;
+    for (size_type i = 0; i < n; ++i) {
+        Counter val = batch.val[i];
+        if (val < min_bucket || val >= max_bucket + bucket_size) {
+            fold(begin, i);
+            grow(val);
+            begin = i;
+        }
+    }
+    fold(begin, n);
+}
+
 void
 HistStor::add(HistStor *hs)
 {
+    flush();
+    hs->flush();
+
     int b_size = hs->size();
     assert(size() == b_size);
     assert(min_bucket == hs->min_bucket);
@@ -1308,6 +1308,46 @@ struct DistParams : public StorageParams
     DistParams(DistType t) : type(t) {}
 };
 
+/**
+ * A fixed buffer of samples for the distribution stats. Samples are
+ * collected here and folded into the buckets in batches, which keeps
+ * the branchy bucket update out of the hot path and lets the
+ * compiler vectorize the bucket index computation.
+ */
+struct SampleBatch
+{
+    /** The number of samples buffered before they are folded in. */
+    static const size_type capacity = 32;
+
+    Counter val[capacity];
+    Counter number[capacity];
+    size_type count;
+
+    SampleBatch() : count(0) {}
+
+    /**
+     * Buffer a sample.
+     * @return True if the buffer is full and needs to be folded in.
+     */
+    bool
+    add(Counter v, int n)
+    {
+        val[count] = v;
+        number[count] = n;
+        return ++count == capacity;
+    }
+
+    /** The number of samples represented by the buffer. */
+    Counter
+    samples() const
+    {
+        Counter total = Counter();
+        for (size_type i = 0; i < count; ++i)
+            total += number[i];
+        return total;
+    }
+};
+
 /**
  * Templatized storage and interface for a distrbution stat.
  */
@@ -1353,6 +1393,8 @@ class DistStor
     Counter samples;
     /** Counter for each bucket. */
     VCounter cvec;
+    /** Samples not yet folded into the counters. */
+    SampleBatch batch;
 
   public:
     DistStor(Info *info)
@@ -1369,28 +1411,16 @@ class DistStor
     void
     sample(Counter val, int number)
     {
-        if (val < min_track)
-            underflow += number;
-        else if (val > max_track)
-            overflow += number;
-        else {
-            size_type index =
-                (size_type)std::floor((val - min_track) / bucket_size);
-            assert(index < size());
-            cvec[index] += number;
-        }
-
-        if (val < min_val)
-            min_val = val;
-
-        if (val > max_val)
-            max_val = val;
-
-        sum += val * number;
-        squares += val * val * number;
-        samples += number;
+        if (batch.add(val, number))
+            flush();
     }
 
+    /**
+     * Fold the buffered samples into the counters, in the order they
+     * were sampled.
+     */
+    void flush();
+
     /**
      * Return the number of buckets in this distribution.
      * @return the number of buckets.
@@ -1404,7 +1434,7 @@ class DistStor
     bool
     zero() const
     {
-        return samples == Counter();
+        return samples + batch.samples() == Counter();
     }
 
     void
@@ -1412,6 +1442,8 @@ class DistStor
     {
         const Params *params = safe_cast<const Params *>(info->storageParams);
 
+        flush();
+
         assert(params->type == Dist);
         data.type = params->type;
         data.min = params->min;
@@ -1442,6 +1474,7 @@ class DistStor
         min_track = params->min;
         max_track = params->max;
         bucket_size = params->bucket_size;
+        batch.count = 0;
 
         min_val = CounterLimits::max();
         max_val = CounterLimits::min();
@@ -1491,6 +1524,19 @@ class HistStor
     Counter samples;
     /** Counter for each bucket. */
     VCounter cvec;
+    /** Samples not yet folded into the counters. */
+    SampleBatch batch;
+
+    /**
+     * Rescale the buckets until they cover a value.
+     */
+    void grow(Counter val);
+
+    /**
+     * Fold part of the buffered samples into the counters, all of
+     * which are covered by the current buckets.
+     */
+    void fold(size_type begin, size_type end);
 
   public:
     HistStor(Info *info)
@@ -1512,35 +1558,18 @@ class HistStor
     void
     sample(Counter val, int number)
     {
-        assert(min_bucket < max_bucket);
-        if (val < min_bucket) {
-            if (min_bucket == 0)
-                grow_convert();
-
-            while (val < min_bucket)
-                grow_out();
-        } else if (val >= max_bucket + bucket_size) {
-            if (min_bucket == 0) {
-                while (val >= max_bucket + bucket_size)
-                    grow_up();
-            } else {
-                while (val >= max_bucket + bucket_size)
-                    grow_out();
-            }
-        }
-
-        size_type index =
-            (int64_t)std::floor((val - min_bucket) / bucket_size);
-
-        assert(index >= 0 && index < size());
-        cvec[index] += number;
-
-        sum += val * number;
-        squares += val * val * number;
-        logs += log(val) * number;
-        samples += number;
+        if (batch.add(val, number))
+            flush();
     }
 
+    /**
+     * Fold the buffered samples into the counters, in the order they
+     * were sampled. The buckets are rescaled at the same samples as
+     * they would have been without buffering, so the result is the
+     * same.
+     */
+    void flush();
+
     /**
      * Return the number of buckets in this distribution.
      * @return the number of buckets.
@@ -1554,7 +1583,7 @@ class HistStor
     bool
     zero() const
     {
-        return samples == Counter();
+        return samples + batch.samples() == Counter();
     }
 
     void
@@ -1562,6 +1591,8 @@ class HistStor
     {
         const Params *params = safe_cast<const Params *>(info->storageParams);
 
+        flush();
+
         assert(params->type == Hist);
         data.type = params->type;
         data.min = min_bucket;
@@ -1592,6 +1623,7 @@ class HistStor
         min_bucket = 0;
         max_bucket = params->buckets - 1;
         bucket_size = 1;
+        batch.count = 0;
 
         size_type size = cvec.size();
         for (off_type i = 0; i < size; ++i)
@@ -0,0 +1,455 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "base/stats/binary.hh"
+#include "base/stats/info.hh"
+#include "base/stats/text.hh"
+#include "base/callback.hh"
+#include "base/misc.hh"
+#include "base/output.hh"
+#include "base/str.hh"
+
+using namespace std;
+
+namespace Stats {
+
+namespace {
+
+const char binaryMagic[8] = { 'M', '5', 'S', 'T', 'A', 'T', 'S', 'B' };
+const uint64_t binaryVersion = 1;
+
+/** Values that can be stored as differences of integers */
+inline bool
+integral(Result value)
+{
+    return value == floor(value) && fabs(value) < 9007199254740992.0;
+}
+
+string
+subname(const vector<string> &subnames, size_type i)
+{
+    if (i < subnames.size() && !subnames[i].empty())
+        return subnames[i];
+    return to_string(i);
+}
+
+} // anonymous namespace
+
+Binary::Binary()
+    : stream(NULL), cursor(0), layoutChanged(false)
+{
+}
+
+Binary::~Binary()
+{
+}
+
+void
+Binary::open(ostream &_stream)
+{
+    if (stream)
+        panic("stream already set!");
+
+    stream = &_stream;
+    if (!valid())
+        fatal("Unable to open output stream for writing\n");
+
+    writeHeader();
+}
+
+void
+Binary::reopen()
+{
+    // a stream that was not truncated already has its header
+    if (!valid() || stream->tellp() != 0)
+        return;
+
+    // without a schema the next dump writes one, followed by values
+    // relative to zero
+    schema.clear();
+    prevValues.clear();
+    writeHeader();
+}
+
+void
+Binary::writeHeader()
+{
+    record.assign(binaryMagic, sizeof(binaryMagic));
+    putVarint(binaryVersion);
+    stream->write(record.data(), record.size());
+}
+
+bool
+Binary::valid() const
+{
+    return stream != NULL && stream->good();
+}
+
+void
+Binary::putVarint(uint64_t value)
+{
+    while (value >= 0x80) {
+        record += (char)(value | 0x80);
+        value >>= 7;
+    }
+    record += (char)value;
+}
+
+void
+Binary::putString(const string &str)
+{
+    putVarint(str.size());
+    record += str;
+}
+
+void
+Binary::putDouble(double value)
+{
+    // little endian, independent of the host
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i)
+        record += (char)(bits >> (8 * i));
+}
+
+void
+Binary::begin()
+{
+    cursor = 0;
+    layoutChanged = false;
+    layout.clear();
+    values.clear();
+    sparse.clear();
+    sparseSizes.clear();
+}
+
+void
+Binary::end()
+{
+    if (!layoutChanged && cursor != schema.size()) {
+        // statistics disappeared from the end
+        layoutChanged = true;
+        layout.assign(schema.begin(), schema.begin() + cursor);
+    }
+
+    record.clear();
+    if (layoutChanged) {
+        schema.swap(layout);
+        writeSchema();
+        prevValues.assign(values.size(), 0.0);
+    }
+    writeValues();
+    prevValues.swap(values);
+
+    stream->write(record.data(), record.size());
+    stream->flush();
+}
+
+bool
+Binary::matches(const Info &info, StatType type, size_t columns,
+                const vector<Counter> &buckets)
+{
+    if (!layoutChanged && cursor < schema.size()) {
+        const Entry &e = schema[cursor];
+        if (e.id == info.id && e.type == type &&
+            e.columns.size() == columns && e.buckets == buckets) {
+            ++cursor;
+            return true;
+        }
+    }
+
+    if (!layoutChanged) {
+        layoutChanged = true;
+        layout.assign(schema.begin(), schema.begin() + cursor);
+    }
+    return false;
+}
+
+void
+Binary::addEntry(const Info &info, StatType type,
+                 const vector<string> &columns,
+                 const vector<Counter> &buckets)
+{
+    layout.push_back(Entry());
+    Entry &e = layout.back();
+    e.id = info.id;
+    e.type = type;
+    e.name = info.name;
+    e.desc = info.desc;
+    e.columns = columns;
+    e.buckets = buckets;
+}
+
+void
+Binary::writeSchema()
+{
+    record += 'S';
+    putVarint(schema.size());
+    for (vector<Entry>::const_iterator e = schema.begin();
+         e != schema.end(); ++e) {
+        putVarint(e->type);
+        putString(e->name);
+        putString(e->desc);
+        putVarint(e->columns.size());
+        for (vector<string>::const_iterator c = e->columns.begin();
+             c != e->columns.end(); ++c)
+            putString(*c);
+    }
+}
+
+void
+Binary::writeValues()
+{
+    // each changed value is preceded by its distance to the previous
+    // changed value, with the low bit telling if the value follows as
+    // an integer difference or as a double, and a zero distance ends
+    // the list
+    record += 'D';
+    size_t last = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        Result cur = values[i];
+        Result prev = prevValues[i];
+        if (memcmp(&cur, &prev, sizeof(Result)) == 0)
+            continue;
+
+        uint64_t gap = i + 1 - last;
+        last = i + 1;
+        if (integral(cur) && integral(prev)) {
+            int64_t delta = (int64_t)cur - (int64_t)prev;
+            putVarint(gap << 1 | 1);
+            putVarint(((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+        } else {
+            putVarint(gap << 1);
+            putDouble(cur);
+        }
+    }
+    putVarint(0);
+
+    // sparse histograms have no fixed layout, so they are written
+    // in full
+    vector<pair<Counter, Counter> >::const_iterator s = sparse.begin();
+    for (size_t i = 0; i < sparseSizes.size(); ++i) {
+        putVarint(sparseSizes[i]);
+        for (size_t j = 0; j < sparseSizes[i]; ++j, ++s) {
+            putDouble(s->first);
+            putDouble(s->second);
+        }
+    }
+}
+
+void
+Binary::visit(const ScalarInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    if (!matches(info, Scalar, 1))
+        addEntry(info, Scalar, vector<string>(1));
+
+    values.push_back(info.result());
+}
+
+void
+Binary::visit(const VectorInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    const VResult &result = info.result();
+    StatType type = dynamic_cast<const FormulaInfo *>(&info) ?
+        Formula : Vector;
+
+    if (!matches(info, type, result.size())) {
+        vector<string> columns(result.size());
+        for (size_type i = 0; i < result.size(); ++i)
+            columns[i] = "::" + subname(info.subnames, i);
+        addEntry(info, type, columns);
+    }
+
+    values.insert(values.end(), result.begin(), result.end());
+}
+
+void
+Binary::visit(const FormulaInfo &info)
+{
+    visit((const VectorInfo &)info);
+}
+
+void
+Binary::distColumns(const DistData &data, const string &prefix,
+                    vector<string> &columns)
+{
+    columns.push_back(prefix + "::samples");
+    columns.push_back(prefix + "::sum");
+    columns.push_back(prefix + "::squares");
+    if (data.type == Deviation)
+        return;
+
+    columns.push_back(prefix + "::min_value");
+    columns.push_back(prefix + "::max_value");
+    columns.push_back(prefix + "::underflows");
+    columns.push_back(prefix + "::overflows");
+    for (size_type i = 0; i < data.cvec.size(); ++i)
+        columns.push_back(prefix + "::" +
+                          ValueToString(data.min + i * data.bucket_size,
+                                        -1));
+}
+
+void
+Binary::distBuckets(const DistData &data, vector<Counter> &buckets)
+{
+    // histograms change their buckets when they rescale
+    if (data.type != Deviation) {
+        buckets.push_back(data.min);
+        buckets.push_back(data.bucket_size);
+    }
+}
+
+void
+Binary::distValues(const DistData &data)
+{
+    values.push_back(data.samples);
+    values.push_back(data.sum);
+    values.push_back(data.squares);
+    if (data.type == Deviation)
+        return;
+
+    values.push_back(data.min_val);
+    values.push_back(data.max_val);
+    values.push_back(data.underflow);
+    values.push_back(data.overflow);
+    values.insert(values.end(), data.cvec.begin(), data.cvec.end());
+}
+
+void
+Binary::visit(const DistInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    size_t columns = 3;
+    if (info.data.type != Deviation)
+        columns += 4 + info.data.cvec.size();
+
+    vector<Counter> buckets;
+    distBuckets(info.data, buckets);
+
+    if (!matches(info, Dist, columns, buckets)) {
+        vector<string> names;
+        distColumns(info.data, "", names);
+        addEntry(info, Dist, names, buckets);
+    }
+
+    distValues(info.data);
+}
+
+void
+Binary::visit(const VectorDistInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    size_t columns = 0;
+    vector<Counter> buckets;
+    for (size_type i = 0; i < info.data.size(); ++i) {
+        columns += 3;
+        if (info.data[i].type != Deviation)
+            columns += 4 + info.data[i].cvec.size();
+        distBuckets(info.data[i], buckets);
+    }
+
+    if (!matches(info, VectorDist, columns, buckets)) {
+        vector<string> names;
+        for (size_type i = 0; i < info.data.size(); ++i)
+            distColumns(info.data[i], "::" + subname(info.subnames, i), names);
+        addEntry(info, VectorDist, names, buckets);
+    }
+
+    for (size_type i = 0; i < info.data.size(); ++i)
+        distValues(info.data[i]);
+}
+
+void
+Binary::visit(const Vector2dInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    if (!matches(info, Vector2d, info.x * info.y)) {
+        vector<string> columns;
+        for (size_type i = 0; i < info.x; ++i)
+            for (size_type j = 0; j < info.y; ++j)
+                columns.push_back("::" + subname(info.subnames, i) + "::" +
+                                  subname(info.y_subnames, j));
+        addEntry(info, Vector2d, columns);
+    }
+
+    values.insert(values.end(), info.cvec.begin(),
+                  info.cvec.begin() + info.x * info.y);
+}
+
+void
+Binary::visit(const SparseHistInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    if (!matches(info, SparseHist, 0))
+        addEntry(info, SparseHist, vector<string>());
+
+    sparseSizes.push_back(info.data.cmap.size());
+    for (MCounter::const_iterator i = info.data.cmap.begin();
+         i != info.data.cmap.end(); ++i)
+        sparse.push_back(make_pair(i->first, (Counter)i->second));
+}
+
+Output *
+initBinary(const string &filename)
+{
+    static Binary binary;
+    static bool connected = false;
+
+    if (!connected) {
+        ostream *os = simout.find(filename);
+        if (!os)
+            os = simout.create(filename, true);
+
+        binary.open(*os);
+        simout.addRedirectCallback(
+            new MakeCallback<Binary, &Binary::reopen>(binary));
+        connected = true;
+    }
+
+    return &binary;
+}
+
+} // namespace Stats
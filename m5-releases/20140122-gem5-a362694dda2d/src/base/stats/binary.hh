@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_STATS_BINARY_HH__
+#define __BASE_STATS_BINARY_HH__
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "base/stats/output.hh"
+#include "base/stats/types.hh"
+#include "base/types.hh"
+
+namespace Stats {
+
+class Info;
+struct DistData;
+
+/**
+ * Statistics output in a compact binary format, intended for frequent
+ * periodic dumps. The layout of the statistics (names, descriptions
+ * and the columns of values they produce) is written once as a schema
+ * record. Every dump after that is a record holding only the values
+ * that changed since the previous dump, with integral values encoded
+ * as variable-length differences. A new schema record is written if
+ * the layout ever changes. The file can be read with the
+ * m5.stats.binary Python module.
+ */
+class Binary : public Output
+{
+  public:
+    /** The kinds of statistics in a schema record. */
+    enum StatType {
+        Scalar = 0,
+        Vector = 1,
+        Dist = 2,
+        VectorDist = 3,
+        Vector2d = 4,
+        Formula = 5,
+        SparseHist = 6
+    };
+
+  protected:
+    struct Entry
+    {
+        int id;
+        StatType type;
+        std::string name;
+        std::string desc;
+        std::vector<std::string> columns;
+        /** Lowest bucket and bucket size of every distribution, which
+         * the column names depend on */
+        std::vector<Counter> buckets;
+    };
+
+    std::ostream *stream;
+
+    /** The layout of the statistics last written */
+    std::vector<Entry> schema;
+
+    /** The statistic in the schema expected to be visited next */
+    size_t cursor;
+
+    /** The layout of this dump, if it differs from the schema */
+    bool layoutChanged;
+    std::vector<Entry> layout;
+
+    /** The values of this and the previous dump */
+    std::vector<Result> values;
+    std::vector<Result> prevValues;
+
+    /** Buckets and counts of the sparse histograms of this dump */
+    std::vector<std::pair<Counter, Counter> > sparse;
+    std::vector<size_t> sparseSizes;
+
+    /** The record being built */
+    std::string record;
+
+    /**
+     * Check that the next statistic of this dump matches the schema.
+     * If it does not, the caller has to describe it with addEntry().
+     */
+    bool matches(const Info &info, StatType type, size_t columns,
+                 const std::vector<Counter> &buckets =
+                 std::vector<Counter>());
+    void addEntry(const Info &info, StatType type,
+                  const std::vector<std::string> &columns,
+                  const std::vector<Counter> &buckets =
+                  std::vector<Counter>());
+
+    void writeHeader();
+
+    void putVarint(uint64_t value);
+    void putString(const std::string &str);
+    void putDouble(double value);
+
+    void writeSchema();
+    void writeValues();
+
+    void distColumns(const DistData &data, const std::string &prefix,
+                     std::vector<std::string> &columns);
+    void distBuckets(const DistData &data, std::vector<Counter> &buckets);
+    void distValues(const DistData &data);
+
+  public:
+    Binary();
+    ~Binary();
+
+    void open(std::ostream &stream);
+
+    /**
+     * Start over after the stream was truncated, e.g. by moving the
+     * output directory of a forked simulator. The header and schema
+     * are written again and the next dump holds absolute values.
+     */
+    void reopen();
+
+    // Implement Visit
+    virtual void visit(const ScalarInfo &info);
+    virtual void visit(const VectorInfo &info);
+    virtual void visit(const DistInfo &info);
+    virtual void visit(const VectorDistInfo &info);
+    virtual void visit(const Vector2dInfo &info);
+    virtual void visit(const FormulaInfo &info);
+    virtual void visit(const SparseHistInfo &info);
+
+    // Implement Output
+    virtual bool valid() const;
+    virtual void begin();
+    virtual void end();
+};
+
+Output *initBinary(const std::string &filename);
+
+} // namespace Stats
+
+#endif // __BASE_STATS_BINARY_HH__
@@ -32,8 +32,11 @@
 #include <cctype>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <vector>
 
+#include "base/callback.hh"
 #include "base/misc.hh"
 #include "base/output.hh"
 #include "base/str.hh"
@@ -70,31 +73,97 @@ setOutput(const string &filename)
 
 ObjectMatch ignore;
 
+bool binary = false;
+
+namespace {
+
+/** Binary trace file magic, followed by the format version */
+const char binaryMagic[8] = { 'M', '5', 'T', 'R', 'A', 'C', 'E', 'B' };
+const char binaryVersion = 1;
+
+string binaryFile;
+size_t bufferSize;
+
+/** The binary trace buffers of all threads, in order of creation */
+vector<Buffer *> buffers;
+mutex buffersLock;
+
+/** The binary trace buffer of the current thread */
+__thread Buffer *threadBuffer = NULL;
+
+Buffer &
+buffer()
+{
+    if (!threadBuffer) {
+        lock_guard<mutex> lock(buffersLock);
+        threadBuffer = new Buffer(bufferSize);
+        buffers.push_back(threadBuffer);
+    }
+    return *threadBuffer;
+}
+
+struct BinaryDumpCallback : public Callback
+{
+    void process() { dumpBinary(); }
+};
+
+} // anonymous namespace
+
 void
-dprintf(Tick when, const std::string &name, const char *format,
-        CPRINTF_DEFINITION)
+enableBinary(const string &filename, size_t size)
 {
-    if (!name.empty() && ignore.match(name))
+    if (binary)
         return;
 
-    std::ostream &os = *dprintf_stream;
+    binaryFile = filename;
+    bufferSize = size;
+    binary = true;
+    registerExitCallback(new BinaryDumpCallback);
+}
 
-    string fmt = "";
-    CPrintfArgsList args(VARARGS_ALLARGS);
+void
+dumpBinary()
+{
+    if (!binary)
+        return;
 
-    if (!name.empty()) {
-        fmt = "%s: " + fmt;
-        args.push_front(name);
-    }
+    lock_guard<mutex> lock(buffersLock);
 
-    if (when != (Tick)-1) {
-        fmt = "%7d: " + fmt;
-        args.push_front(when);
+    ostream *os = simout.create(binaryFile, true);
+    os->write(binaryMagic, sizeof(binaryMagic));
+    os->put(binaryVersion);
+    for (auto b = buffers.begin(); b != buffers.end(); ++b)
+        (*b)->write(*os);
+    simout.close(os);
+}
+
+void
+dprintf(Tick when, const std::string &name, const Debug::Flag *flag,
+        const char *format, VARARGS_DEFINITION(Record))
+{
+    if (!name.empty() && ignore.match(name))
+        return;
+
+    if (binary) {
+        Buffer &buf = buffer();
+        buf.begin(when, flag, name, format);
+        Record record(buf);
+        VARARGS_ADDARGS(record);
+        buf.end();
+        return;
     }
 
-    fmt += format;
+    std::ostream &os = *dprintf_stream;
+
+    if (when != (Tick)-1)
+        ccprintf(os, "%7d: ", when);
+
+    if (!name.empty())
+        ccprintf(os, "%s: ", name);
 
-    ccprintf(os, fmt.c_str(), args);
+    cp::Print print(os, format);
+    Record record(print);
+    VARARGS_ADDARGS(record);
     os.flush();
 }
 
@@ -104,6 +173,14 @@ dump(Tick when, const std::string &name, const void *d, int len)
     if (!name.empty() && ignore.match(name))
         return;
 
+    if (binary) {
+        Buffer &buf = buffer();
+        buf.begin(when, NULL, name, NULL);
+        buf.putString(static_cast<const char *>(d), len);
+        buf.end();
+        return;
+    }
+
     std::ostream &os = *dprintf_stream;
 
     string fmt = "";
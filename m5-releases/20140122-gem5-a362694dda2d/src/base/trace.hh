@@ -32,11 +32,14 @@
 #ifndef __BASE_TRACE_HH__
 #define __BASE_TRACE_HH__
 
+#include <sstream>
 #include <string>
+#include <type_traits>
 
 #include "base/cprintf.hh"
 #include "base/debug.hh"
 #include "base/match.hh"
+#include "base/trace_buffer.hh"
 #include "base/types.hh"
 #include "sim/core.hh"
 
@@ -55,8 +58,105 @@ void dumpStatus();
 extern ObjectMatch ignore;
 extern const std::string DefaultName;
 
-void dprintf(Tick when, const std::string &name, const char *format,
-             CPRINTF_DECLARATION);
+/**
+ * Whether debug output is recorded into the binary trace buffers
+ * instead of being formatted.
+ */
+extern bool binary;
+
+/**
+ * Switch to binary tracing. Every thread records into a ring buffer
+ * of its own, and the buffers are written to filename in the output
+ * directory by dumpBinary(), at the latest when the simulator exits.
+ * Text written straight to output(), such as the instruction traces,
+ * still goes to the text debug file.
+ *
+ * @param filename Output file for the buffers
+ * @param size Size of the ring buffer of each thread in bytes
+ */
+void enableBinary(const std::string &filename, size_t size);
+
+/** Write the current contents of the binary trace buffers. */
+void dumpBinary();
+
+/**
+ * Receiver for the arguments of a DPRINTF. The arguments are either
+ * handed to a cprintf formatter or recorded unformatted into a binary
+ * trace buffer. Arguments that are not numbers, enums or strings are
+ * formatted when they are recorded.
+ */
+class Record
+{
+  protected:
+    cp::Print *print;
+    Buffer *buffer;
+
+    void put(bool v) { buffer->putUnsigned(v, sizeof(v)); }
+    void put(char v) { buffer->putSigned(v, sizeof(v)); }
+    void put(signed char v) { buffer->putSigned(v, sizeof(v)); }
+    void put(unsigned char v) { buffer->putUnsigned(v, sizeof(v)); }
+    void put(short v) { buffer->putSigned(v, sizeof(v)); }
+    void put(unsigned short v) { buffer->putUnsigned(v, sizeof(v)); }
+    void put(int v) { buffer->putSigned(v, sizeof(v)); }
+    void put(unsigned int v) { buffer->putUnsigned(v, sizeof(v)); }
+    void put(long v) { buffer->putSigned(v, sizeof(v)); }
+    void put(unsigned long v) { buffer->putUnsigned(v, sizeof(v)); }
+    void put(long long v) { buffer->putSigned(v, sizeof(v)); }
+    void put(unsigned long long v) { buffer->putUnsigned(v, sizeof(v)); }
+    void put(float v) { buffer->putDouble(v); }
+    void put(double v) { buffer->putDouble(v); }
+    void put(const char *v) { buffer->putString(v, strlen(v)); }
+    void put(char *v) { buffer->putString(v, strlen(v)); }
+    void put(const std::string &v) { buffer->putString(v.data(), v.size()); }
+
+    template <typename T>
+    void
+    put(const T &v)
+    {
+        put(v, std::is_enum<T>());
+    }
+
+    /** Enums are recorded as integers, so conversions apply to them. */
+    template <typename T>
+    void
+    put(const T &v, std::true_type)
+    {
+        buffer->putSigned((long long)v, sizeof(v));
+    }
+
+    template <typename T>
+    void
+    put(const T &v, std::false_type)
+    {
+        std::ostringstream s;
+        s << v;
+        put(s.str());
+    }
+
+  public:
+    Record(cp::Print &print) : print(&print), buffer(NULL) {}
+    Record(Buffer &buffer) : print(NULL), buffer(&buffer) {}
+
+    template <typename T>
+    void
+    add_arg(const T &data)
+    {
+        if (print)
+            print->add_arg(data);
+        else
+            put(data);
+    }
+
+    void
+    end_args()
+    {
+        if (print)
+            print->end_args();
+    }
+};
+
+void dprintf(Tick when, const std::string &name, const Debug::Flag *flag,
+             const char *format, VARARGS_DECLARATION(Record));
 void dump(Tick when, const std::string &name, const void *data, int len);
 
 } // namespace Trace
@@ -95,19 +195,21 @@ inline const std::string &name() { return Trace::DefaultName; }
 #define DPRINTF(x, ...) do {                                    \
     using namespace Debug;                                      \
     if (DTRACE(x))                                              \
-        Trace::dprintf(curTick(), name(), __VA_ARGS__);           \
+        Trace::dprintf(curTick(), name(), &Debug::x, __VA_ARGS__);\
 } while (0)
 
 #define DPRINTFS(x, s, ...) do {                                \
     using namespace Debug;                                      \
     if (DTRACE(x))                                              \
-        Trace::dprintf(curTick(), s->name(), __VA_ARGS__);      \
+        Trace::dprintf(curTick(), s->name(), &Debug::x,         \
+                       __VA_ARGS__);                            \
 } while (0)
 
 #define DPRINTFR(x, ...) do {                                   \
     using namespace Debug;                                      \
     if (DTRACE(x))                                              \
-        Trace::dprintf((Tick)-1, std::string(), __VA_ARGS__);   \
+        Trace::dprintf((Tick)-1, std::string(), &Debug::x,      \
+                       __VA_ARGS__);                            \
 } while (0)
 
 #define DDUMPN(data, count) do {                                \
@@ -115,11 +217,11 @@ inline const std::string &name() { return Trace::DefaultName; }
 } while (0)
 
 #define DPRINTFN(...) do {                                      \
-    Trace::dprintf(curTick(), name(), __VA_ARGS__);               \
+    Trace::dprintf(curTick(), name(), NULL, __VA_ARGS__);         \
 } while (0)
 
 #define DPRINTFNR(...) do {                                     \
-    Trace::dprintf((Tick)-1, string(), __VA_ARGS__);            \
+    Trace::dprintf((Tick)-1, string(), NULL, __VA_ARGS__);      \
 } while (0)
 
 #else // !TRACING_ON
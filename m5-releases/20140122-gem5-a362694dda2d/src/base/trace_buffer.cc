@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <ostream>
+
+#include "base/debug.hh"
+#include "base/intmath.hh"
+#include "base/trace_buffer.hh"
+
+using namespace std;
+
+namespace Trace {
+
+namespace {
+
+void
+appendVarint(string &str, uint64_t value)
+{
+    while (value >= 0x80) {
+        str += (char)(value | 0x80);
+        value >>= 7;
+    }
+    str += (char)value;
+}
+
+void
+appendTable(string &str, const vector<string> &table)
+{
+    appendVarint(str, table.size());
+    for (auto s = table.begin(); s != table.end(); ++s) {
+        appendVarint(str, s->size());
+        str += *s;
+    }
+}
+
+} // anonymous namespace
+
+Buffer::Buffer(size_t size)
+    : ring(isPowerOf2(size) ? size : ULL(1) << (floorLog2(size) + 1)),
+      head(0), tail(0), dropped(0)
+{
+}
+
+uint32_t
+Buffer::flagId(const Debug::Flag *flag)
+{
+    if (!flag)
+        return 0;
+
+    auto i = flagIds.find(flag);
+    if (i != flagIds.end())
+        return i->second;
+
+    flags.push_back(flag->name());
+    flagIds[flag] = flags.size();
+    return flags.size();
+}
+
+uint32_t
+Buffer::nameId(const string &name)
+{
+    if (name.empty())
+        return 0;
+
+    auto i = nameIds.find(name);
+    if (i != nameIds.end())
+        return i->second;
+
+    names.push_back(name);
+    nameIds[name] = names.size();
+    return names.size();
+}
+
+uint32_t
+Buffer::formatId(const char *format)
+{
+    if (!format)
+        return 0;
+
+    // Format strings are almost always literals, but check the text
+    // in case the address is reused for a different string
+    auto i = formatIds.find(format);
+    if (i != formatIds.end() && formats[i->second - 1] == format)
+        return i->second;
+
+    formats.push_back(format);
+    formatIds[format] = formats.size();
+    return formats.size();
+}
+
+void
+Buffer::begin(Tick when, const Debug::Flag *flag, const string &name,
+              const char *format)
+{
+    record.clear();
+    // no tick is encoded as 0
+    putVarint(when + 1);
+    putVarint(flagId(flag));
+    putVarint(nameId(name));
+    putVarint(formatId(format));
+}
+
+void
+Buffer::copyIn(uint64_t pos, const void *data, size_t len)
+{
+    size_t offset = pos & (ring.size() - 1);
+    size_t first = min(len, ring.size() - offset);
+    memcpy(&ring[offset], data, first);
+    memcpy(&ring[0], (const char *)data + first, len - first);
+}
+
+void
+Buffer::copyOut(uint64_t pos, void *data, size_t len) const
+{
+    size_t offset = pos & (ring.size() - 1);
+    size_t first = min(len, ring.size() - offset);
+    memcpy(data, &ring[offset], first);
+    memcpy((char *)data + first, &ring[0], len - first);
+}
+
+void
+Buffer::end()
+{
+    uint32_t len = record.size();
+    uint64_t need = sizeof(len) + len;
+    if (need > ring.size()) {
+        ++dropped;
+        return;
+    }
+
+    // make room by overwriting the oldest records
+    while (tail + need - head > ring.size()) {
+        uint32_t old;
+        copyOut(head, &old, sizeof(old));
+        head += sizeof(old) + old;
+        ++dropped;
+    }
+
+    copyIn(tail, &len, sizeof(len));
+    copyIn(tail + sizeof(len), record.data(), len);
+    tail += need;
+}
+
+void
+Buffer::write(ostream &os) const
+{
+    string header;
+    appendVarint(header, dropped);
+    appendTable(header, flags);
+    appendTable(header, names);
+    appendTable(header, formats);
+    appendVarint(header, tail - head);
+    os.write(header.data(), header.size());
+
+    size_t offset = head & (ring.size() - 1);
+    size_t first = min(tail - head, (uint64_t)(ring.size() - offset));
+    os.write(&ring[offset], first);
+    os.write(&ring[0], tail - head - first);
+}
+
+} // namespace Trace
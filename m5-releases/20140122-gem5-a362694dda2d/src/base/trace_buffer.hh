@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_TRACE_BUFFER_HH__
+#define __BASE_TRACE_BUFFER_HH__
+
+#include <cstring>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "base/hashmap.hh"
+#include "base/types.hh"
+
+namespace Debug {
+class Flag;
+}
+
+namespace Trace {
+
+/**
+ * Ring buffer of binary debug records. Instead of formatting a DPRINTF,
+ * the binary trace mode records its tick, flag, object name, format
+ * string and raw arguments here. Flags, names and format strings are
+ * stored once in tables and referred to by id. When the ring is full
+ * the oldest records are overwritten, so the buffer always holds the
+ * most recent history.
+ *
+ * Each simulation thread records into a buffer of its own, so there
+ * is no locking on the recording path. The buffers are written out by
+ * Trace::dumpBinary() and formatted offline by
+ * util/decode_debug_trace.py.
+ */
+class Buffer
+{
+  public:
+    /** Argument tags, or'ed with the size of integer arguments. */
+    enum ArgType {
+        Signed = 0x10,
+        Unsigned = 0x20,
+        Double = 0x30,
+        String = 0x40
+    };
+
+    /**
+     * @param size Capacity of the ring in bytes, rounded up to a power
+     * of two
+     */
+    Buffer(size_t size);
+
+    /**
+     * Start a record.
+     *
+     * @param when Tick of the record, (Tick)-1 for none
+     * @param flag Flag of the DPRINTF, NULL for none
+     * @param name Object name, empty for none
+     * @param format Format string, NULL for a data dump
+     */
+    void begin(Tick when, const Debug::Flag *flag, const std::string &name,
+               const char *format);
+
+    void
+    putSigned(int64_t value, int size)
+    {
+        record += (char)(Signed | size);
+        putVarint((uint64_t)(value << 1) ^ (uint64_t)(value >> 63));
+    }
+
+    void
+    putUnsigned(uint64_t value, int size)
+    {
+        record += (char)(Unsigned | size);
+        putVarint(value);
+    }
+
+    void
+    putDouble(double value)
+    {
+        char bytes[sizeof(value)];
+        std::memcpy(bytes, &value, sizeof(value));
+        record += (char)Double;
+        record.append(bytes, sizeof(value));
+    }
+
+    void
+    putString(const char *str, size_t len)
+    {
+        record += (char)String;
+        putVarint(len);
+        record.append(str, len);
+    }
+
+    /** Finish the record and add it to the ring. */
+    void end();
+
+    /** Write the tables and the records in the ring to a stream. */
+    void write(std::ostream &os) const;
+
+  private:
+    void
+    putVarint(uint64_t value)
+    {
+        while (value >= 0x80) {
+            record += (char)(value | 0x80);
+            value >>= 7;
+        }
+        record += (char)value;
+    }
+
+    uint32_t flagId(const Debug::Flag *flag);
+    uint32_t nameId(const std::string &name);
+    uint32_t formatId(const char *format);
+
+    void copyIn(uint64_t pos, const void *data, size_t len);
+    void copyOut(uint64_t pos, void *data, size_t len) const;
+
+    /** The record being built */
+    std::string record;
+
+    /** Ring storage */
+    std::vector<char> ring;
+    /** Position of the oldest record, counted from the first record */
+    uint64_t head;
+    /** Position after the newest record */
+    uint64_t tail;
+    /** Number of records overwritten or too large for the ring */
+    uint64_t dropped;
+
+    /**
+     * Id tables. An id is an index into the string vector + 1, id 0
+     * means none. Flags and formats are looked up by address; a
+     * format that does not match the string it was first seen with
+     * at that address gets a new id.
+     * @{
+     */
+    m5::hash_map<const void *, uint32_t> flagIds;
+    std::vector<std::string> flags;
+    m5::hash_map<std::string, uint32_t> nameIds;
+    std::vector<std::string> names;
+    m5::hash_map<const void *, uint32_t> formatIds;
+    std::vector<std::string> formats;
+    /** @} */
+};
+
+} // namespace Trace
+
+#endif // __BASE_TRACE_BUFFER_HH__
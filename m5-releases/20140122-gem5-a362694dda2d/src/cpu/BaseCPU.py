@@ -133,6 +133,12 @@ class BaseCPU(MemObject):
     function_trace = Param.Bool(False, "Enable function trace")
     function_trace_start = Param.Tick(0, "Tick to start function trace")
 
+    simpoint_profile = Param.Bool(False, "Generate SimPoint BBVs")
+    simpoint_interval = Param.UInt64(100000000, "SimPoint Interval Size (insts)")
+    simpoint_profile_file = Param.String("simpoint.bb.gz", "SimPoint BBV file")
+    simpoint_binary = Param.Bool(False,
+        "Write the SimPoint BBVs in binary instead of text")
+
     checker = Param.BaseCPU(NULL, "checker CPU")
 
     do_checkpoint_insts = Param.Bool(True,
@@ -223,6 +223,13 @@ BaseCPU::BaseCPU(Params *p, bool is_checker)
         }
     }
 
+    simpointProfiler = NULL;
+    if (p->simpoint_profile) {
+        simpointProfiler = new SimPointProfiler(p->simpoint_profile_file,
+                                                p->simpoint_interval,
+                                                p->simpoint_binary);
+    }
+
     // The interrupts should always be present unless this CPU is
     // switched in later or in case it is a checker CPU
     if (!params()->switched_out && !is_checker) {
@@ -255,6 +262,7 @@ BaseCPU::enableFunctionTrace()
 BaseCPU::~BaseCPU()
 {
     delete profileEvent;
+    delete simpointProfiler;
     delete[] comLoadEventQueue;
     delete[] comInstEventQueue;
 }
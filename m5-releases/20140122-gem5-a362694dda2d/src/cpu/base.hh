@@ -58,6 +58,7 @@
 #include "arch/isa_traits.hh"
 #include "arch/microcode_rom.hh"
 #include "base/statistics.hh"
+#include "cpu/simpoint.hh"
 #include "mem/mem_object.hh"
 #include "sim/eventq.hh"
 #include "sim/full_system.hh"
@@ -441,6 +442,24 @@ class BaseCPU : public MemObject
     void enableFunctionTrace();
     void traceFunctionsInternal(Addr pc);
 
+    // SimPoint profiling
+  private:
+    /** BBV profiler, NULL unless simpoint_profile is set */
+    SimPointProfiler *simpointProfiler;
+
+  public:
+    /**
+     * Profile a committed macro instruction for SimPoints, if enabled.
+     *
+     * @param pc PC of the instruction
+     * @param is_control True if the instruction is a control instruction
+     */
+    void profileSimPoint(Addr pc, bool is_control)
+    {
+        if (simpointProfiler)
+            simpointProfiler->profile(pc, is_control);
+    }
+
   private:
     static std::vector<BaseCPU *> cpuList;   //!< Static global cpu list
 
@@ -144,6 +144,10 @@ class DerivO3CPU(BaseCPU):
     needsTSO = Param.Bool(buildEnv['TARGET_ISA'] == 'x86',
                           "Enable TSO Memory model")
 
+    elastic_trace_file = Param.String("",
+        "Elastic trace of the committed memory accesses, for replay by "
+        "the traffic generator")
+
     def addCheckerCpu(self):
         if buildEnv['TARGET_ISA'] in ['arm']:
             from ArmTLB import ArmTLB
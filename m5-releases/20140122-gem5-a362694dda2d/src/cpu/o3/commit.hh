@@ -53,6 +53,8 @@
 
 struct DerivO3CPUParams;
 
+class ElasticTrace;
+
 template <class>
 struct O3ThreadState;
 
@@ -485,6 +487,9 @@ class DefaultCommit
         a possible livelock senario.  */
     bool avoidQuiesceLiveLock;
 
+    /** Elastic trace of the committed memory accesses, if any. */
+    ElasticTrace *elasticTrace;
+
     /** Updates commit stats based on this instruction. */
     void updateComInstStats(DynInstPtr &inst);
 
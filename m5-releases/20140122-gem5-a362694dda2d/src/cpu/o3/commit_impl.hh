@@ -53,6 +53,7 @@
 #include "config/the_isa.hh"
 #include "cpu/checker/cpu.hh"
 #include "cpu/o3/commit.hh"
+#include "cpu/o3/elastic_trace.hh"
 #include "cpu/o3/thread_state.hh"
 #include "cpu/base.hh"
 #include "cpu/exetrace.hh"
@@ -106,7 +107,8 @@ DefaultCommit<Impl>::DefaultCommit(O3CPU *_cpu, DerivO3CPUParams *params)
       drainPending(false),
       trapLatency(params->trapLatency),
       canHandleInterrupts(true),
-      avoidQuiesceLiveLock(false)
+      avoidQuiesceLiveLock(false),
+      elasticTrace(NULL)
 {
     _status = Active;
     _nextStatus = Inactive;
@@ -152,6 +154,12 @@ DefaultCommit<Impl>::DefaultCommit(O3CPU *_cpu, DerivO3CPUParams *params)
         squashAfterInst[tid] = NULL;
     }
     interrupt = NoFault;
+
+    if (params->elastic_trace_file != "") {
+        elasticTrace = new ElasticTrace(name(), params->elastic_trace_file,
+                                        params->numROBEntries,
+                                        params->system->cacheLineSize());
+    }
 }
 
 template <class Impl>
@@ -1217,6 +1225,9 @@ DefaultCommit<Impl>::commitHead(DynInstPtr &head_inst, unsigned inst_num)
 
     updateComInstStats(head_inst);
 
+    if (elasticTrace)
+        elasticTrace->commit(head_inst);
+
     if (FullSystem) {
         if (thread[tid]->profile) {
             thread[tid]->profilePC = head_inst->instAddr();
@@ -147,6 +147,13 @@ FullO3CPU<Impl>::TickEvent::description() const
     return "FullO3CPU tick";
 }
 
+template <class Impl>
+const std::string
+FullO3CPU<Impl>::TickEvent::name() const
+{
+    return cpu->name() + ".tick_event";
+}
+
 template <class Impl>
 FullO3CPU<Impl>::ActivateThreadEvent::ActivateThreadEvent()
     : Event(CPU_Switch_Pri)
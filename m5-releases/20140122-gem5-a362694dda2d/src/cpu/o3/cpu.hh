@@ -208,6 +208,8 @@ class FullO3CPU : public BaseO3CPU
         void process();
         /** Returns the description of the tick event. */
         const char *description() const;
+        /** Returns the name of the tick event, after the CPU. */
+        const std::string name() const;
     };
 
     /** The tick event used for scheduling CPU ticks. */
@@ -140,6 +140,11 @@ class BaseO3DynInst : public BaseDynInst<Impl>
     int32_t storeTick;
 #endif
 
+    /** Tick when the instruction last started executing. */
+    Tick execTick;
+    /** Tick when the instruction wrote back its result. */
+    Tick writebackTick;
+
     /** Reads a misc. register, including any side-effects the read
      * might have as defined by the architecture.
      */
@@ -121,6 +121,9 @@ BaseO3DynInst<Impl>::initVars()
 
     _numDestMiscRegs = 0;
 
+    execTick = 0;
+    writebackTick = 0;
+
 #if TRACING_ON
     // Value -1 indicates that particular phase
     // hasn't happened (yet).
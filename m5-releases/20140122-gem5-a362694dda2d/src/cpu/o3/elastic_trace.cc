@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "base/callback.hh"
+#include "base/misc.hh"
+#include "base/output.hh"
+#include "config/have_protobuf.hh"
+#include "cpu/o3/elastic_trace.hh"
+#include "sim/core.hh"
+
+#if HAVE_PROTOBUF
+#include "proto/inst_dep_record.pb.h"
+#include "proto/protoio.hh"
+#endif
+
+using namespace std;
+
+void
+ElasticTrace::Deps::add(const Dep &d)
+{
+    unsigned oldest = 0;
+    for (unsigned i = 0; i < size; ++i) {
+        if (dep[i].id == d.id)
+            return;
+        if (dep[i].id < dep[oldest].id)
+            oldest = i;
+    }
+
+    if (size < MaxDeps)
+        dep[size++] = d;
+    else if (dep[oldest].id < d.id)
+        dep[oldest] = d;
+}
+
+ElasticTrace::ElasticTrace(const string &name, const string &filename,
+                           unsigned window_size, unsigned line_size)
+    : stream(NULL), lineSize(line_size), nextId(0), weight(0),
+      haveIndep(false), indepExecTick(0)
+{
+#if HAVE_PROTOBUF
+    stream = new ProtoOutputStream(simout.resolve(filename));
+
+    Message::InstDepRecordHeader header_msg;
+    header_msg.set_obj_id(name);
+    header_msg.set_tick_freq(SimClock::Frequency);
+    header_msg.set_window_size(window_size);
+    stream->write(header_msg);
+
+    // The destructor is not called at exit, make sure the stream is
+    // flushed and the file closed.
+    registerExitCallback(
+        new MakeCallback<ElasticTrace, &ElasticTrace::close>(this));
+#else
+    fatal("%s: elastic traces need protobuf support\n", name);
+#endif
+}
+
+ElasticTrace::~ElasticTrace()
+{
+    close();
+}
+
+void
+ElasticTrace::close()
+{
+#if HAVE_PROTOBUF
+    delete stream;
+    stream = NULL;
+#endif
+}
+
+void
+ElasticTrace::readReg(unsigned reg)
+{
+    if (reg < regDeps.size()) {
+        const Deps &deps = regDeps[reg];
+        for (unsigned i = 0; i < deps.size; ++i)
+            current.add(deps.dep[i]);
+    }
+}
+
+void
+ElasticTrace::writeReg(unsigned reg, bool load, Tick done)
+{
+    if (reg >= regDeps.size())
+        regDeps.resize(reg + 1);
+
+    Deps &deps = regDeps[reg];
+    if (load) {
+        Dep d = { nextId - 1, done };
+        deps.clear();
+        deps.add(d);
+    } else {
+        deps = current;
+    }
+}
+
+void
+ElasticTrace::recordAccess(bool load, Addr addr, unsigned size,
+                           unsigned flags, Tick exec_tick)
+{
+#if HAVE_PROTOBUF
+    if (!stream)
+        return;
+
+    Message::InstDepRecord rec;
+    rec.set_type(load ? Message::InstDepRecord::LOAD :
+                 Message::InstDepRecord::STORE);
+    rec.set_p_addr(addr);
+    rec.set_size(min(size, lineSize - (unsigned)(addr & (lineSize - 1))));
+    if (flags)
+        rec.set_flags(flags);
+
+    // the access waits for the last of the loads it depends on, or
+    // follows the previous access that depends on none, as accesses
+    // without dependencies issue as soon as they enter the window
+    Tick ready = 0;
+    for (unsigned i = 0; i < current.size; ++i) {
+        rec.add_reg_dep(nextId - current.dep[i].id);
+        ready = max(ready, current.dep[i].done);
+    }
+    if (!current.size)
+        ready = haveIndep ? indepExecTick : exec_tick;
+    rec.set_comp_delay(exec_tick > ready ? exec_tick - ready : 0);
+    rec.set_weight(weight);
+
+    stream->write(rec);
+#endif
+
+    if (!current.size) {
+        haveIndep = true;
+        indepExecTick = exec_tick;
+    }
+    weight = 0;
+    ++nextId;
+}
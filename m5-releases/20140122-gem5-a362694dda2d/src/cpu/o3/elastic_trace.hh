@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_O3_ELASTIC_TRACE_HH__
+#define __CPU_O3_ELASTIC_TRACE_HH__
+
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+#include "mem/request.hh"
+
+class ProtoOutputStream;
+
+/**
+ * Capture of an elastic trace: the memory accesses of the committed
+ * instructions together with the loads they depend on through
+ * registers and the compute delay since those loads completed. The
+ * trace generator replays such a trace by issuing every access once
+ * its dependencies are resolved, so the memory-level parallelism of
+ * the CPU follows the memory system being studied instead of the
+ * timing of the one the trace was captured with.
+ *
+ * Dependencies are followed through the physical registers at commit.
+ * A register is not reallocated before every instruction reading its
+ * old value has committed, so this is exact for register dataflow.
+ * Only the most recent loads are kept for every register, and memory
+ * dependencies through stores and loads are not recorded.
+ */
+class ElasticTrace
+{
+  public:
+    /** Maximum number of loads a record depends on. */
+    static const unsigned MaxDeps = 4;
+
+    /**
+     * @param name Name of the capturing object in the trace header
+     * @param filename Trace file, in the output directory if relative
+     * @param window_size Instruction window of the CPU
+     * @param line_size Cache line size, accesses are cut at the end
+     * of a line as the LSQ splits them
+     */
+    ElasticTrace(const std::string &name, const std::string &filename,
+                 unsigned window_size, unsigned line_size);
+
+    ~ElasticTrace();
+
+    /**
+     * Add a committed instruction to the trace. It has to be called
+     * in commit order.
+     *
+     * @param inst The instruction, with its execute and writeback
+     * ticks set
+     */
+    template <class DynInstPtr>
+    void
+    commit(const DynInstPtr &inst)
+    {
+        ++weight;
+        current.clear();
+        for (int i = 0; i < inst->numSrcRegs(); ++i)
+            readReg(inst->renamedSrcRegIdx(i));
+
+        bool load = false;
+        if ((inst->isLoad() || inst->isStore()) && inst->effAddrValid() &&
+            !inst->uncacheable() &&
+            !(inst->memReqFlags & Request::NO_ACCESS)) {
+            load = inst->isLoad();
+            recordAccess(load, inst->physEffAddr, inst->effSize,
+                         inst->memReqFlags, inst->execTick);
+        }
+
+        for (int i = 0; i < inst->numDestRegs(); ++i)
+            writeReg(inst->renamedDestRegIdx(i), load, inst->writebackTick);
+    }
+
+    /** Flush the trace and close the file. */
+    void close();
+
+  private:
+    /** A load that a value depends on. */
+    struct Dep {
+        /** Record number of the load */
+        uint64_t id;
+        /** Tick when the load wrote back its data */
+        Tick done;
+    };
+
+    /** The most recent loads a value depends on. */
+    struct Deps {
+        unsigned size;
+        Dep dep[MaxDeps];
+
+        Deps() : size(0) { }
+
+        void clear() { size = 0; }
+
+        /** Add a load, dropping the oldest one if full. */
+        void add(const Dep &d);
+    };
+
+    /** Add the dependencies of a source register to the current ones. */
+    void readReg(unsigned reg);
+
+    /**
+     * Set the dependencies of a destination register.
+     *
+     * @param reg The physical register
+     * @param load Was it written by the load just recorded
+     * @param done Writeback tick of the instruction
+     */
+    void writeReg(unsigned reg, bool load, Tick done);
+
+    /** Write a record for a memory access. */
+    void recordAccess(bool load, Addr addr, unsigned size, unsigned flags,
+                      Tick exec_tick);
+
+    /** The trace file, NULL once closed */
+    ProtoOutputStream *stream;
+
+    const unsigned lineSize;
+
+    /** Loads the value of every physical register depends on */
+    std::vector<Deps> regDeps;
+
+    /** Dependencies of the instruction being committed */
+    Deps current;
+
+    /** Number of the next record */
+    uint64_t nextId;
+
+    /** Instructions committed since the last record */
+    unsigned weight;
+
+    /** Has a record without dependencies been written */
+    bool haveIndep;
+
+    /** Execute tick of the last record without dependencies */
+    Tick indepExecTick;
+};
+
+#endif // __CPU_O3_ELASTIC_TRACE_HH__
@@ -1252,6 +1252,8 @@ DefaultIEW<Impl>::executeInsts()
 
         Fault fault = NoFault;
 
+        inst->execTick = curTick();
+
         // Execute instruction.
         // Note that if the instruction faults, it will be handled
         // at the commit stage.
@@ -1468,6 +1470,7 @@ DefaultIEW<Impl>::writebackInsts()
         // are first sent to commit.  Instead commit must tell the LSQ
         // when it's ready to execute the uncached load.
         if (!inst->isSquashed() && inst->isExecuted() && inst->getFault() == NoFault) {
+            inst->writebackTick = curTick();
             int dependents = instQueue.wakeDependents(inst);
 
             for (int i = 0; i < inst->numDestRegs(); i++) {
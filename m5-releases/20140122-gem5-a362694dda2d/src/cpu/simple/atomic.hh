@@ -43,30 +43,10 @@
 #ifndef __CPU_SIMPLE_ATOMIC_HH__
 #define __CPU_SIMPLE_ATOMIC_HH__
 
-#include "base/hashmap.hh"
 #include "cpu/simple/base.hh"
 #include "params/AtomicSimpleCPU.hh"
 
-/**
- *  Start and end address of basic block for SimPoint profiling.
- *  This structure is used to look up the hash table of BBVs.
- *  - first: PC of first inst in basic block
- *  - second: PC of last inst in basic block
- */
-typedef std::pair<Addr, Addr> BasicBlockRange;
-
-/** Overload hash function for BasicBlockRange type */
-__hash_namespace_begin
-template <>
-struct hash<BasicBlockRange>
-{
-  public:
-    size_t operator()(const BasicBlockRange &bb) const {
-        return hash<Addr>()(bb.first + bb.second);
-    }
-};
-__hash_namespace_end
-
+class BaseCache;
 
 class AtomicSimpleCPU : public BaseSimpleCPU
 {
@@ -86,6 +66,7 @@ class AtomicSimpleCPU : public BaseSimpleCPU
         TickEvent(AtomicSimpleCPU *c);
         void process();
         const char *description() const;
+        const std::string name() const;
     };
 
     TickEvent tickEvent;
@@ -176,56 +157,23 @@ class AtomicSimpleCPU : public BaseSimpleCPU
     AtomicCPUPort dcachePort;
 
     bool fastmem;
-    Request ifetch_req;
-    Request data_read_req;
-    Request data_write_req;
 
-    bool dcache_access;
-    Tick dcache_latency;
+    /** Caches warmed by the accesses while the caches are bypassed. */
+    BaseCache *warmICache;
+    BaseCache *warmDCache;
 
     /**
-     * Profile basic blocks for SimPoints.
-     * Called at every macro inst to increment basic block inst counts and
-     * to profile block if end of block.
-     */
-    void profileSimPoint();
-
-    /** Data structures for SimPoints BBV generation
-     *  @{
+     * Tell a cache about an access that went straight to memory, if
+     * the memory system is in the cache warming mode.
      */
+    void warmCache(BaseCache *cache, const Packet &pkt);
 
-    /** Whether SimPoint BBV profiling is enabled */
-    const bool simpoint;
-    /** SimPoint profiling interval size in instructions */
-    const uint64_t intervalSize;
-
-    /** Inst count in current basic block */
-    uint64_t intervalCount;
-    /** Excess inst count from previous interval*/
-    uint64_t intervalDrift;
-    /** Pointer to SimPoint BBV output stream */
-    std::ostream *simpointStream;
-
-    /** Basic Block information */
-    struct BBInfo {
-        /** Unique ID */
-        uint64_t id;
-        /** Num of static insts in BB */
-        uint64_t insts;
-        /** Accumulated dynamic inst count executed by BB */
-        uint64_t count;
-    };
-
-    /** Hash table containing all previously seen basic blocks */
-    m5::hash_map<BasicBlockRange, BBInfo> bbMap;
-    /** Currently executing basic block */
-    BasicBlockRange currentBBV;
-    /** inst count in current basic block */
-    uint64_t currentBBVInstCount;
+    Request ifetch_req;
+    Request data_read_req;
+    Request data_write_req;
 
-    /** @}
-     *  End of data structures for SimPoints BBV generation
-     */
+    bool dcache_access;
+    Tick dcache_latency;
 
   protected:
 
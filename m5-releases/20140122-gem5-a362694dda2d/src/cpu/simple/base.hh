@@ -191,6 +191,8 @@ class BaseSimpleCPU : public BaseCPU
         if (!curStaticInst->isMicroop() || curStaticInst->isLastMicroop()) {
             numInst++;
             numInsts++;
+            profileSimPoint(thread->pcState().instAddr(),
+                            curStaticInst->isControl());
         }
         numOp++;
         numOps++;
@@ -45,6 +45,8 @@
 #ifndef __CPU_SIMPLE_THREAD_HH__
 #define __CPU_SIMPLE_THREAD_HH__
 
+#include <bitset>
+
 #include "arch/decoder.hh"
 #include "arch/isa.hh"
 #include "arch/isa_traits.hh"
@@ -114,6 +116,11 @@ class SimpleThread : public ThreadState
 #ifdef ISA_HAS_CC_REGS
     TheISA::CCReg ccRegs[TheISA::NumCCRegs];
 #endif
+
+    /** Registers written since the last clearRegsDirty() (flat index) */
+    std::bitset<TheISA::NumIntRegs> intRegsDirty;
+    std::bitset<TheISA::NumFloatRegs> floatRegsDirty;
+
     TheISA::ISA *const isa;    // one "instance" of the current ISA.
 
     TheISA::PCState _pcState;
@@ -233,9 +240,34 @@ class SimpleThread : public ThreadState
 #ifdef ISA_HAS_CC_REGS
         memset(ccRegs, 0, sizeof(ccRegs));
 #endif
+        intRegsDirty.set();
+        floatRegsDirty.set();
         isa->clear();
     }
 
+    /** @{ */
+    /**
+     * Track registers written since the last call to clearRegsDirty().
+     * HAsim uses this to return only the registers modified by an
+     * emulated instruction instead of scanning the whole register file.
+     */
+    bool intRegDirty(int reg_idx)
+    {
+        return intRegsDirty[isa->flattenIntIndex(reg_idx)];
+    }
+
+    bool floatRegDirty(int reg_idx)
+    {
+        return floatRegsDirty[isa->flattenFloatIndex(reg_idx)];
+    }
+
+    void clearRegsDirty()
+    {
+        intRegsDirty.reset();
+        floatRegsDirty.reset();
+    }
+    /** @} */
+
     //
     // New accessors for new decoder.
     //
@@ -426,14 +458,21 @@ class SimpleThread : public ThreadState
     }
 
     uint64_t readIntRegFlat(int idx) { return intRegs[idx]; }
-    void setIntRegFlat(int idx, uint64_t val) { intRegs[idx] = val; }
+    void setIntRegFlat(int idx, uint64_t val) {
+        intRegs[idx] = val;
+        intRegsDirty[idx] = true;
+    }
 
     FloatReg readFloatRegFlat(int idx) { return floatRegs.f[idx]; }
-    void setFloatRegFlat(int idx, FloatReg val) { floatRegs.f[idx] = val; }
+    void setFloatRegFlat(int idx, FloatReg val) {
+        floatRegs.f[idx] = val;
+        floatRegsDirty[idx] = true;
+    }
 
     FloatRegBits readFloatRegBitsFlat(int idx) { return floatRegs.i[idx]; }
     void setFloatRegBitsFlat(int idx, FloatRegBits val) {
         floatRegs.i[idx] = val;
+        floatRegsDirty[idx] = true;
     }
 
 #ifdef ISA_HAS_CC_REGS
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <ostream>
+
+#include "base/misc.hh"
+#include "base/output.hh"
+#include "cpu/simpoint.hh"
+
+using namespace std;
+
+namespace
+{
+
+/** Binary file magic, followed by the version and the interval size */
+const char bbvMagic[8] = { 'M', '5', 'S', 'P', 'B', 'B', 'V', '\n' };
+const uint64_t bbvVersion = 1;
+
+/** Initial log2 size of the block table */
+const unsigned initialTableBits = 12;
+
+inline size_t
+hashPC(Addr pc, unsigned bits)
+{
+    // Fibonacci hashing, the top bits mix in all of the PC
+    return (size_t)((pc * ULL(0x9e3779b97f4a7c15)) >> (64 - bits));
+}
+
+} // anonymous namespace
+
+SimPointProfiler::SimPointProfiler(const string &filename,
+                                   uint64_t interval_size, bool binary)
+    : stream(simout.create(filename, binary)), binary(binary),
+      intervalSize(interval_size), intervalCount(0), intervalDrift(0),
+      blockStart(0), blockInsts(0), tableBits(initialTableBits)
+{
+    if (!stream || !stream->good())
+        fatal("Unable to open SimPoint profile %s\n", filename);
+
+    Slot empty = { 0, 0 };
+    table.assign(ULL(1) << tableBits, empty);
+
+    if (binary) {
+        record.assign(bbvMagic, sizeof(bbvMagic));
+        putVarint(bbvVersion);
+        putVarint(intervalSize);
+        stream->write(record.data(), record.size());
+    }
+}
+
+SimPointProfiler::~SimPointProfiler()
+{
+    simout.close(stream);
+}
+
+uint32_t
+SimPointProfiler::lookup(Addr start, Addr end, uint64_t insts)
+{
+    size_t mask = table.size() - 1;
+    for (size_t i = hashPC(start, tableBits); ; i = (i + 1) & mask) {
+        Slot &slot = table[i];
+        if (slot.id == 0) {
+            // A new (previously unseen) basic block, give it the
+            // next unique id
+            Block block = { end, insts, 0 };
+            blocks.push_back(block);
+            slot.start = start;
+            slot.id = blocks.size();
+
+            uint32_t id = slot.id;
+            if (blocks.size() * 2 > table.size())
+                grow();
+            return id;
+        }
+
+        if (slot.start == start && blocks[slot.id - 1].end == end)
+            return slot.id;
+    }
+}
+
+void
+SimPointProfiler::grow()
+{
+    vector<Slot> old;
+    old.swap(table);
+
+    ++tableBits;
+    Slot empty = { 0, 0 };
+    table.assign(ULL(1) << tableBits, empty);
+
+    size_t mask = table.size() - 1;
+    for (auto s = old.begin(); s != old.end(); ++s) {
+        if (s->id == 0)
+            continue;
+        size_t i = hashPC(s->start, tableBits);
+        while (table[i].id != 0)
+            i = (i + 1) & mask;
+        table[i] = *s;
+    }
+}
+
+void
+SimPointProfiler::endBlock(Addr end)
+{
+    Block &block = blocks[lookup(blockStart, end, blockInsts) - 1];
+    assert(block.insts == blockInsts);
+
+    if (block.count == 0)
+        touched.push_back(&block - &blocks[0] + 1);
+    block.count += blockInsts;
+    blockInsts = 0;
+
+    // Reached end of interval if the sum of the current inst count
+    // (intervalCount) and the excessive inst count from the previous
+    // interval (intervalDrift) is greater than/equal to the interval size.
+    if (intervalCount + intervalDrift >= intervalSize) {
+        dumpInterval();
+        intervalDrift = (intervalCount + intervalDrift) - intervalSize;
+        intervalCount = 0;
+    }
+}
+
+void
+SimPointProfiler::dumpInterval()
+{
+    sort(touched.begin(), touched.end());
+
+    if (binary) {
+        record.clear();
+        putVarint(touched.size());
+        uint32_t last = 0;
+        for (auto id = touched.begin(); id != touched.end(); ++id) {
+            Block &block = blocks[*id - 1];
+            putVarint(*id - last);
+            putVarint(block.count);
+            block.count = 0;
+            last = *id;
+        }
+        stream->write(record.data(), record.size());
+    } else {
+        *stream << "T";
+        for (auto id = touched.begin(); id != touched.end(); ++id) {
+            Block &block = blocks[*id - 1];
+            *stream << ":" << *id << ":" << block.count << " ";
+            block.count = 0;
+        }
+        *stream << "\n";
+    }
+
+    touched.clear();
+}
+
+void
+SimPointProfiler::putVarint(uint64_t value)
+{
+    while (value >= 0x80) {
+        record += (char)(value | 0x80);
+        value >>= 7;
+    }
+    record += (char)value;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_SIMPOINT_HH__
+#define __CPU_SIMPOINT_HH__
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+
+/**
+ * Basic block vector (BBV) profiler for SimPoints. The CPU calls
+ * profile() for every committed macro instruction. A basic block ends
+ * at a control instruction and is identified by the PCs of its first
+ * and last instruction. Each block gets a unique id, in the order the
+ * blocks are first seen, and at the end of every interval the number
+ * of instructions executed by each block is written out.
+ *
+ * The blocks are found through an open-addressing table hashed on the
+ * start PC, and the blocks executed in the current interval are kept
+ * in a list so that an interval only costs as much as the blocks it
+ * touched.
+ *
+ * The text output is the format read by the SimPoint tool, one line
+ * per interval of the form "T:id:count :id:count ...". The binary
+ * output holds the same information as variable-length integers and
+ * can be converted to text with util/simpoint_bbv.py.
+ */
+class SimPointProfiler
+{
+  public:
+    /**
+     * @param filename Output file, created in the output directory
+     * @param interval_size Interval length in instructions
+     * @param binary Write the binary format instead of text
+     */
+    SimPointProfiler(const std::string &filename, uint64_t interval_size,
+                     bool binary);
+    ~SimPointProfiler();
+
+    /**
+     * Count a committed macro instruction.
+     *
+     * @param pc PC of the instruction
+     * @param is_control True if the instruction ends a basic block
+     */
+    void profile(Addr pc, bool is_control)
+    {
+        if (!blockInsts)
+            blockStart = pc;
+
+        ++intervalCount;
+        ++blockInsts;
+
+        if (is_control)
+            endBlock(pc);
+    }
+
+  private:
+    /** Basic block information, the id of a block is its index + 1 */
+    struct Block {
+        /** PC of the last inst in the block */
+        Addr end;
+        /** Num of static insts in the block */
+        uint64_t insts;
+        /** Dynamic inst count executed by the block in this interval */
+        uint64_t count;
+    };
+
+    /** Hash table slot, an id of 0 marks an empty slot */
+    struct Slot {
+        Addr start;
+        uint32_t id;
+    };
+
+    /** Account the current block, which ends at end. */
+    void endBlock(Addr end);
+
+    /** Find the id of a block, adding the block if it is new. */
+    uint32_t lookup(Addr start, Addr end, uint64_t insts);
+
+    /** Double the size of the hash table. */
+    void grow();
+
+    /** Write the counts of the interval and clear them. */
+    void dumpInterval();
+
+    void putVarint(uint64_t value);
+
+    /** Output stream */
+    std::ostream *stream;
+    /** Whether to write the binary format */
+    const bool binary;
+
+    /** Interval size in instructions */
+    const uint64_t intervalSize;
+    /** Inst count in the current interval */
+    uint64_t intervalCount;
+    /** Excess inst count from the previous interval */
+    uint64_t intervalDrift;
+
+    /** PC of the first inst in the current block */
+    Addr blockStart;
+    /** Inst count in the current block */
+    uint64_t blockInsts;
+
+    /** All blocks seen so far, indexed by id - 1 */
+    std::vector<Block> blocks;
+    /** Open-addressing hash table of blocks keyed by start PC */
+    std::vector<Slot> table;
+    /** log2 of the hash table size */
+    unsigned tableBits;
+    /** Ids of the blocks executed in the current interval */
+    std::vector<uint32_t> touched;
+    /** Buffer for a binary interval record */
+    std::string record;
+};
+
+#endif // __CPU_SIMPOINT_HH__
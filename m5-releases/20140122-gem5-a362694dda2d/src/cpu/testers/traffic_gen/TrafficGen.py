@@ -59,6 +59,13 @@ from MemObject import MemObject
 # forward to create very complex behaviours, simply by arranging them
 # in graphs. The graph transitions can also be annotated with
 # probabilities, effectively making it a Markov Chain.
+#
+# Packet traces from a CommMonitor are replayed with their recorded
+# timing (TRACE <file> <addr offset>). Elastic traces, captured from
+# the O3 CPU with its elastic_trace_file parameter, are replayed with
+# every access issued once the loads it depends on have completed
+# and within the instruction window of the CPU, so the timing follows
+# the memory system (ELASTIC <file> <addr offset> [<window size>]).
 class TrafficGen(MemObject):
     type = 'TrafficGen'
     cxx_header = "cpu/testers/traffic_gen/traffic_gen.hh"
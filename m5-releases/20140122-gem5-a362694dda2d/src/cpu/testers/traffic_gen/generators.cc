@@ -39,10 +39,12 @@
  *          Sascha Bischoff
  */
 
+#include "base/intmath.hh"
 #include "base/random.hh"
 #include "base/trace.hh"
 #include "cpu/testers/traffic_gen/generators.hh"
 #include "debug/TrafficGen.hh"
+#include "proto/inst_dep_record.pb.h"
 #include "proto/packet.pb.h"
 
 BaseGen::BaseGen(const std::string& _name, MasterID master_id, Tick _duration)
@@ -334,3 +336,246 @@ TraceGen::exit()
     // file
     trace.reset();
 }
+
+ElasticGen::InputStream::InputStream(const std::string& filename)
+    : trace(filename), window(0)
+{
+    init();
+}
+
+void
+ElasticGen::InputStream::init()
+{
+    Message::InstDepRecordHeader header_msg;
+    if (!trace.read(header_msg))
+        panic("Failed to read elastic trace header\n");
+
+    if (header_msg.tick_freq() != SimClock::Frequency) {
+        panic("Trace was recorded with a different tick frequency %d\n",
+              header_msg.tick_freq());
+    }
+
+    window = header_msg.window_size();
+}
+
+void
+ElasticGen::InputStream::reset()
+{
+    trace.reset();
+    init();
+}
+
+bool
+ElasticGen::InputStream::read(Node& node)
+{
+    Message::InstDepRecord rec;
+    if (!trace.read(rec))
+        return false;
+
+    node.cmd = rec.type() == Message::InstDepRecord::LOAD ?
+        MemCmd::ReadReq : MemCmd::WriteReq;
+    node.addr = rec.p_addr();
+    node.size = rec.size();
+    node.flags = rec.has_flags() ? rec.flags() : 0;
+    node.deps.assign(rec.reg_dep().begin(), rec.reg_dep().end());
+    node.compDelay = rec.comp_delay();
+    node.inst = rec.weight();
+    return true;
+}
+
+ElasticGen::ElasticGen(const std::string& _name, MasterID master_id,
+                       Tick _duration, const std::string& trace_file,
+                       Addr addr_offset, unsigned window_size)
+    : BaseGen(_name, master_id, _duration),
+      trace(trace_file),
+      addrOffset(addr_offset),
+      windowSize(window_size ? window_size : trace.windowSize()),
+      haveNext(false), nextId(0), instCount(0), firstId(0),
+      lastIndep(0), indepPending(false), indepIssueTick(0)
+{
+    if (!windowSize)
+        fatal("%s: no window size given for elastic trace %s\n",
+              name(), trace_file);
+
+    // every record takes at least one instruction, so the window
+    // never holds more records than instructions
+    doneTicks.resize(ULL(1) << ceilLog2(2 * windowSize));
+}
+
+void
+ElasticGen::readNext()
+{
+    haveNext = trace.read(nextNode);
+    if (haveNext) {
+        instCount += nextNode.inst;
+        nextNode.inst = instCount;
+    }
+}
+
+void
+ElasticGen::enter()
+{
+    nextId = 0;
+    instCount = 0;
+    firstId = 0;
+    indepPending = false;
+    indepIssueTick = curTick();
+    std::fill(doneTicks.begin(), doneTicks.end(), 0);
+
+    readNext();
+    admit();
+}
+
+void
+ElasticGen::admit()
+{
+    const uint64_t ring = doneTicks.size();
+
+    while (haveNext && (window.empty() ||
+                        nextNode.inst - window.front().inst < windowSize)) {
+        uint64_t id = nextId++;
+        window.push_back(nextNode);
+        Node& n = window.back();
+        n.pending = 0;
+        n.readyTick = 0;
+        n.afterIssue = n.deps.empty();
+        n.done = false;
+
+        if (n.afterIssue) {
+            // follow the issue of the previous record without
+            // dependencies, or the start of the replay for the first
+            // one, these records issue in order
+            if (indepPending) {
+                node(lastIndep).nextIndep = id;
+                ++n.pending;
+            } else {
+                n.readyTick = indepIssueTick + n.compDelay;
+            }
+            lastIndep = id;
+            indepPending = true;
+        } else {
+            for (auto d = n.deps.begin(); d != n.deps.end(); ++d) {
+                if (*d == 0 || *d > id)
+                    continue;
+                uint64_t dep = id - *d;
+                if (dep >= firstId && !node(dep).done) {
+                    node(dep).dependents.push_back(id);
+                    ++n.pending;
+                } else {
+                    // the completion tick is lost for records so far
+                    // back, they completed long ago
+                    Tick done = *d <= ring ? doneTicks[dep & (ring - 1)] : 0;
+                    n.readyTick = std::max(n.readyTick, done + n.compDelay);
+                }
+            }
+        }
+
+        if (!n.pending)
+            ready.push(ReadyEntry(n.readyTick, id));
+
+        readNext();
+    }
+}
+
+void
+ElasticGen::resolve(uint64_t id, Tick when)
+{
+    Node& n = node(id);
+    n.readyTick = std::max(n.readyTick, when + n.compDelay);
+    assert(n.pending);
+    if (--n.pending == 0)
+        ready.push(ReadyEntry(n.readyTick, id));
+}
+
+void
+ElasticGen::complete(uint64_t id)
+{
+    Node& n = node(id);
+    n.done = true;
+    doneTicks[id & (doneTicks.size() - 1)] = curTick();
+
+    for (auto d = n.dependents.begin(); d != n.dependents.end(); ++d)
+        resolve(*d, curTick());
+    n.dependents.clear();
+
+    // retire in order and make room for more records
+    while (!window.empty() && window.front().done) {
+        window.pop_front();
+        ++firstId;
+    }
+    admit();
+}
+
+PacketPtr
+ElasticGen::getNextPacket()
+{
+    assert(!ready.empty());
+    uint64_t id = ready.top().second;
+    ready.pop();
+
+    Node& n = node(id);
+
+    DPRINTF(TrafficGen, "ElasticGen::getNextPacket: %d %c %d %d 0x%x\n",
+            id, n.cmd.isRead() ? 'r' : 'w', n.addr, n.size, n.flags);
+
+    PacketPtr pkt = getPacket(n.addr + addrOffset, n.size, n.cmd, n.flags);
+
+    // the next record without dependencies may be waiting for this
+    // one to issue
+    if (n.afterIssue) {
+        indepIssueTick = curTick();
+        if (id == lastIndep)
+            indepPending = false;
+        else
+            resolve(n.nextIndep, curTick());
+    }
+
+    if (pkt->isRead())
+        outstanding[pkt->req] = id;
+    else
+        complete(id);
+
+    return pkt;
+}
+
+bool
+ElasticGen::recvResponse(PacketPtr pkt)
+{
+    auto i = outstanding.find(pkt->req);
+    if (i == outstanding.end())
+        return false;
+
+    uint64_t id = i->second;
+    outstanding.erase(i);
+    DPRINTF(TrafficGen, "ElasticGen::recvResponse: %d\n", id);
+    complete(id);
+    return true;
+}
+
+Tick
+ElasticGen::nextPacketTick(bool elastic, Tick delay) const
+{
+    // the replay follows the responses, so it is always elastic
+    if (ready.empty())
+        return MaxTick;
+
+    return std::max(ready.top().first, curTick());
+}
+
+void
+ElasticGen::exit()
+{
+    if (!traceComplete()) {
+        warn("Elastic trace player %s was unable to replay the entire "
+             "trace!\n", name());
+    }
+
+    // forget about the accesses in flight and start over again from
+    // the beginning of the file
+    window.clear();
+    ready = std::priority_queue<ReadyEntry, std::vector<ReadyEntry>,
+                                std::greater<ReadyEntry> >();
+    outstanding.clear();
+    haveNext = false;
+    trace.reset();
+}
@@ -49,6 +49,12 @@
 #ifndef __CPU_TRAFFIC_GEN_GENERATORS_HH__
 #define __CPU_TRAFFIC_GEN_GENERATORS_HH__
 
+#include <deque>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include "base/hashmap.hh"
 #include "mem/packet.hh"
 #include "proto/protoio.hh"
 
@@ -130,6 +136,16 @@ class BaseGen
      */
     virtual Tick nextPacketTick(bool elastic, Tick delay) const = 0;
 
+    /**
+     * Receive the response to a packet of this generator, before it
+     * is deleted. By default do nothing.
+     *
+     * @param pkt The response
+     * @return true if the response may have made a packet ready
+     * earlier than the last nextPacketTick
+     */
+    virtual bool recvResponse(PacketPtr pkt) { return false; }
+
 };
 
 /**
@@ -459,4 +475,222 @@ class TraceGen : public BaseGen
     bool traceComplete;
 };
 
+/**
+ * The elastic generator replays an elastic trace captured from the O3
+ * CPU. Instead of issuing the accesses at recorded times, every access
+ * is issued once the loads it depends on have completed and its
+ * compute delay has passed, and no access is issued beyond the
+ * instruction window of the CPU from the oldest one that is not
+ * complete. The timing and the memory-level parallelism thus respond
+ * to the latency of the memory system, which makes the trace usable
+ * for cache and memory design sweeps.
+ *
+ * Stores are complete as soon as they are sent, as they would be once
+ * in the store buffer, and loads when their response is received.
+ */
+class ElasticGen : public BaseGen
+{
+
+  private:
+
+    /** A record of the trace in the instruction window. */
+    struct Node {
+
+        /** Read or write */
+        MemCmd cmd;
+
+        /** The address for the request, without the offset */
+        Addr addr;
+
+        /** The size of the access */
+        unsigned size;
+
+        /** Request flags to use */
+        Request::FlagsType flags;
+
+        /** Distance back to the records this one depends on */
+        std::vector<uint64_t> deps;
+
+        /** Delay from the resolution of the dependencies to issue */
+        Tick compDelay;
+
+        /** Instruction count of the trace up to this record */
+        uint64_t inst;
+
+        /** Number of dependencies not yet resolved */
+        unsigned pending;
+
+        /** Tick when the resolved dependencies allow issue */
+        Tick readyTick;
+
+        /**
+         * Does it follow the issue of the previous record without
+         * dependencies, having none itself
+         */
+        bool afterIssue;
+
+        /** The next record without dependencies, if this is one */
+        uint64_t nextIndep;
+
+        /** Has the access completed */
+        bool done;
+
+        /** Records waiting for this one to complete */
+        std::vector<uint64_t> dependents;
+    };
+
+    /**
+     * The InputStream encapsulates an elastic trace file and reads
+     * the records into nodes.
+     */
+    class InputStream
+    {
+
+      private:
+
+        /// Input file stream for the protobuf trace
+        ProtoInputStream trace;
+
+        /// Instruction window of the CPU that captured the trace
+        unsigned window;
+
+      public:
+
+        /**
+         * Create a trace input stream for a given file name.
+         *
+         * @param filename Path to the file to read from
+         */
+        InputStream(const std::string& filename);
+
+        /**
+         * Reset the stream such that it can be played once
+         * again.
+         */
+        void reset();
+
+        /**
+         * Check the trace header and read the window size.
+         */
+        void init();
+
+        /**
+         * Attempt to read a record from the stream.
+         *
+         * @param node Node to populate
+         * @return True if a record could be read successfully
+         */
+        bool read(Node& node);
+
+        /** Window size in the header, zero if not known */
+        unsigned windowSize() const { return window; }
+    };
+
+  public:
+
+    /**
+     * Create an elastic trace generator.
+     *
+     * @param _name Name to use for status and debug
+     * @param master_id MasterID set on each request
+     * @param _duration duration of this state before transitioning
+     * @param trace_file File to read the records from
+     * @param addr_offset Positive offset to add to trace address
+     * @param window_size Instruction window, zero to use the one in
+     * the trace
+     */
+    ElasticGen(const std::string& _name, MasterID master_id,
+               Tick _duration, const std::string& trace_file,
+               Addr addr_offset, unsigned window_size);
+
+    void enter();
+
+    PacketPtr getNextPacket();
+
+    void exit();
+
+    /**
+     * Returns the tick when the oldest ready access can be issued,
+     * or MaxTick if none is ready. There may still be accesses
+     * waiting for responses.
+     */
+    Tick nextPacketTick(bool elastic, Tick delay) const;
+
+    bool recvResponse(PacketPtr pkt);
+
+  private:
+
+    /** Node of a record in the window */
+    Node& node(uint64_t id) { return window[id - firstId]; }
+
+    /** Read the next record of the trace, if there is one. */
+    void readNext();
+
+    /** Move records into the window as long as there is room. */
+    void admit();
+
+    /** Resolve one dependency of a node. */
+    void resolve(uint64_t id, Tick when);
+
+    /** Complete an access and retire what is done from the window. */
+    void complete(uint64_t id);
+
+    /** Is the trace done and every access complete */
+    bool traceComplete() const { return !haveNext && window.empty(); }
+
+    /** Input stream used for reading the input trace file */
+    InputStream trace;
+
+    /**
+     * Offset for memory requests. Used to shift the trace
+     * away from the CPU address space.
+     */
+    const Addr addrOffset;
+
+    /** Instruction window size */
+    const unsigned windowSize;
+
+    /** The next record of the trace, not yet in the window */
+    Node nextNode;
+
+    /** Is there a next record */
+    bool haveNext;
+
+    /** Number of the next record read from the trace */
+    uint64_t nextId;
+
+    /** Instruction count of the trace read so far */
+    uint64_t instCount;
+
+    /** The records in the window, oldest first */
+    std::deque<Node> window;
+
+    /** Number of the oldest record in the window */
+    uint64_t firstId;
+
+    /** Last record without dependencies put in the window */
+    uint64_t lastIndep;
+
+    /** Is that record still waiting to issue */
+    bool indepPending;
+
+    /** Issue tick of the last record without dependencies */
+    Tick indepIssueTick;
+
+    /**
+     * Completion tick of recent records, indexed by the record
+     * number modulo the size, for dependencies on records that have
+     * left the window.
+     */
+    std::vector<Tick> doneTicks;
+
+    /** Records ready to issue, ordered by tick and age */
+    typedef std::pair<Tick, uint64_t> ReadyEntry;
+    std::priority_queue<ReadyEntry, std::vector<ReadyEntry>,
+                        std::greater<ReadyEntry> > ready;
+
+    /** Loads waiting for their response */
+    m5::hash_map<const Request*, uint64_t> outstanding;
+};
+
 #endif
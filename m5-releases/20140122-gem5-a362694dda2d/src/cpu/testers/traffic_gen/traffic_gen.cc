@@ -247,6 +247,19 @@ TrafficGen::parseConfig()
                     states[id] = new TraceGen(name(), masterID, duration,
                                               traceFile, addrOffset);
                     DPRINTF(TrafficGen, "State: %d TraceGen\n", id);
+                } else if (mode == "ELASTIC") {
+                    string traceFile;
+                    Addr addrOffset;
+                    unsigned windowSize = 0;
+
+                    // the window size is optional and taken from the
+                    // trace if not given
+                    is >> traceFile >> addrOffset >> windowSize;
+
+                    states[id] = new ElasticGen(name(), masterID, duration,
+                                                traceFile, addrOffset,
+                                                windowSize);
+                    DPRINTF(TrafficGen, "State: %d ElasticGen\n", id);
                 } else if (mode == "IDLE") {
                     states[id] = new IdleGen(name(), masterID, duration);
                     DPRINTF(TrafficGen, "State: %d IdleGen\n", id);
@@ -431,11 +444,25 @@ TrafficGen::regStats()
         .desc("Time spent waiting due to back-pressure (ticks)");
 }
 
-bool
-TrafficGen::TrafficGenPort::recvTimingResp(PacketPtr pkt)
+void
+TrafficGen::recvTimingResp(PacketPtr pkt)
 {
+    bool earlier = states[currState]->recvResponse(pkt);
+
     delete pkt->req;
     delete pkt;
 
-    return true;
+    // a response may let the state send its next packet earlier than
+    // scheduled, unless we are waiting for a retry or draining, only
+    // ask the states that depend on responses as asking others for
+    // the next tick may advance them
+    if (earlier && updateEvent.scheduled() && retryPkt == NULL) {
+        Tick next = states[currState]->nextPacketTick(elasticReq, 0);
+        if (next < nextPacketTick) {
+            nextPacketTick = next;
+            Tick nextEventTick = std::min(nextPacketTick, nextTransitionTick);
+            if (nextEventTick < updateEvent.when())
+                reschedule(updateEvent, nextEventTick);
+        }
+    }
 }
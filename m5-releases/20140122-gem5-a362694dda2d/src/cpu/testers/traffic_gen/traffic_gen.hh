@@ -93,6 +93,15 @@ class TrafficGen : public MemObject
      */
     void recvRetry();
 
+    /**
+     * Receive a response, let the current state know about it and,
+     * if it depends on responses, see if that lets it send a packet
+     * earlier.
+     *
+     * @param pkt The response
+     */
+    void recvTimingResp(PacketPtr pkt);
+
     /** Struct to represent a probabilistic transition during parsing. */
     struct Transition {
         uint32_t from;
@@ -150,7 +159,11 @@ class TrafficGen : public MemObject
 
         void recvRetry() { trafficGen.recvRetry(); }
 
-        bool recvTimingResp(PacketPtr pkt);
+        bool recvTimingResp(PacketPtr pkt)
+        {
+            trafficGen.recvTimingResp(pkt);
+            return true;
+        }
 
       private:
 
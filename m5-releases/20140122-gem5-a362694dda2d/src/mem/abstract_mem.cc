@@ -42,6 +42,8 @@
  *          Andreas Hansson
  */
 
+#include <mutex>
+
 #include "arch/registers.hh"
 #include "config/the_isa.hh"
 #include "debug/LLSC.hh"
@@ -60,6 +62,14 @@ using namespace std;
 void (*HAsimNoteMemoryRead)(Addr paddr, uint64_t size) = NULL;
 void (*HAsimNoteMemoryWrite)(Addr paddr, uint64_t size) = NULL;
 
+//
+// Set by HAsim when contexts are emulated on multiple host threads.  Memory
+// state (LL/SC tracking and statistics) is then updated under this lock.
+// The HAsimNote callbacks are invoked before the lock is taken since they
+// may recursively access memory.
+//
+std::mutex *HAsimMemoryMutex = NULL;
+
 
 AbstractMemory::AbstractMemory(const Params *p) :
     MemObject(p), range(params()->range), pmemAddr(NULL),
@@ -335,6 +345,10 @@ AbstractMemory::access(PacketPtr pkt)
         }
     }
 
+    std::unique_lock<std::mutex> hasim_lock;
+    if (HAsimMemoryMutex != NULL)
+        hasim_lock = std::unique_lock<std::mutex>(*HAsimMemoryMutex);
+
     uint8_t *hostAddr = pmemAddr + pkt->getAddr() - range.start();
 
     if (pkt->cmd == MemCmd::SwapReq) {
@@ -423,6 +437,10 @@ AbstractMemory::functionalAccess(PacketPtr pkt)
         }
     }
 
+    std::unique_lock<std::mutex> hasim_lock;
+    if (HAsimMemoryMutex != NULL)
+        hasim_lock = std::unique_lock<std::mutex>(*HAsimMemoryMutex);
+
     uint8_t *hostAddr = pmemAddr + pkt->getAddr() - range.start();
 
     if (pkt->isRead()) {
@@ -261,6 +261,17 @@ class AbstractMemory : public MemObject
      */
     Addr start() const { return range.start(); }
 
+    /**
+     * Transform a physical address in this memory to the host address
+     * in the backing store. No range check is performed, and the
+     * memory must not be null.
+     *
+     * @param addr Physical address within the memory range
+     * @return Pointer into the host backing store
+     */
+    uint8_t* toHostAddr(Addr addr) const
+    { return pmemAddr + addr - range.start(); }
+
     /**
      *  Should this memory be passed to the kernel and part of the OS
      *  physical memory layout.
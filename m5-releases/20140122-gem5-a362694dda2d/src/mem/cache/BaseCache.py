@@ -70,3 +70,5 @@ class BaseCache(MemObject):
     addr_ranges = VectorParam.AddrRange([AllMemory], "The address range for the CPU-side port")
     system = Param.System(Parent.any, "System we belong to")
     tags = Param.BaseTags(LRU(), "Tag Store for LRU caches")
+    warm_next = Param.BaseCache(NULL,
+        "Next level of the hierarchy when warming the caches")
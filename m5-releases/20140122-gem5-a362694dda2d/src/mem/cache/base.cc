@@ -49,6 +49,7 @@
 #include "debug/Drain.hh"
 #include "mem/cache/tags/fa_lru.hh"
 #include "mem/cache/tags/lru.hh"
+#include "mem/cache/tags/packed_tags.hh"
 #include "mem/cache/base.hh"
 #include "mem/cache/cache.hh"
 #include "mem/cache/mshr.hh"
@@ -79,6 +80,7 @@ BaseCache::BaseCache(const Params *p)
       noTargetMSHR(NULL),
       missCount(p->max_miss_count),
       addrRanges(p->addr_ranges.begin(), p->addr_ranges.end()),
+      warmNext(p->warm_next), warmPending(false),
       system(p->system)
 {
 }
@@ -119,6 +121,9 @@ BaseCache::init()
     if (!cpuSidePort->isConnected() || !memSidePort->isConnected())
         fatal("Cache ports on %s are not connected\n", name());
     cpuSidePort->sendRangeChange();
+
+    if (warmNext)
+        warmNext->warmUpper.push_back(this);
 }
 
 BaseMasterPort &
@@ -749,6 +754,17 @@ BaseCache::regStats()
         .desc("Number of misses that were no-allocate")
         ;
 
+    warmHits
+        .name(name() + ".warm_hits")
+        .desc("number of hits while warming")
+        .flags(nozero)
+        ;
+
+    warmMisses
+        .name(name() + ".warm_misses")
+        .desc("number of misses while warming")
+        .flags(nozero)
+        ;
 }
 
 unsigned int
@@ -768,6 +784,33 @@ BaseCache::drain(DrainManager *dm)
     return 0;
 }
 
+void
+BaseCache::drainResume()
+{
+    // the memory mode is changed while the system is drained, fill
+    // the blocks we allocated while warming now that we no longer
+    // bypass the caches
+    if (warmPending && !system->bypassCaches()) {
+        fillWarmedBlocks();
+        warmPending = false;
+    }
+
+    MemObject::drainResume();
+}
+
+bool
+BaseCache::warmSnoopUpper(Addr blk_addr, BaseCache *except, bool invalidate)
+{
+    bool shared = false;
+    for (auto c = warmUpper.begin(); c != warmUpper.end(); ++c) {
+        if (*c == except)
+            continue;
+        shared |= (*c)->warmSnoop(blk_addr, invalidate);
+        shared |= (*c)->warmSnoopUpper(blk_addr, NULL, invalidate);
+    }
+    return shared;
+}
+
 BaseCache *
 BaseCacheParams::create()
 {
@@ -783,6 +826,8 @@ BaseCacheParams::create()
         if (numSets == 1)
             warn("Consider using FALRU tags for a fully associative cache\n");
         return new Cache<LRU>(this);
+    } else if (dynamic_cast<PackedTags*>(tags)) {
+        return new Cache<PackedTags>(this);
     } else {
         fatal("No suitable tags selected\n");
     }
@@ -292,6 +292,15 @@ class BaseCache : public MemObject
      * Normally this is all possible memory addresses. */
     const AddrRangeList addrRanges;
 
+    /** The cache below this one in the warming hierarchy, if any. */
+    BaseCache *warmNext;
+
+    /** The caches that have this one as their next level. */
+    std::vector<BaseCache *> warmUpper;
+
+    /** Are there blocks allocated by warming still without data? */
+    bool warmPending;
+
   public:
     /** System we are currently operating in. */
     System *system;
@@ -430,6 +439,11 @@ class BaseCache : public MemObject
 
     Stats::Scalar mshr_no_allocate_misses;
 
+    /** Number of hits while warming. */
+    Stats::Scalar warmHits;
+    /** Number of misses while warming. */
+    Stats::Scalar warmMisses;
+
     /**
      * @}
      */
@@ -560,6 +574,85 @@ class BaseCache : public MemObject
 
     virtual unsigned int drain(DrainManager *dm);
 
+    /**
+     * Read the data of the blocks allocated while warming once the
+     * caches are no longer bypassed.
+     */
+    virtual void drainResume();
+
+    /** @{ */
+    /**
+     * Cache warming. While the memory system is in the
+     * 'atomic_noncaching' mode a CPU accesses memory directly and
+     * reports the addresses to its caches through warm(). Only the
+     * tags, replacement state and the dirty and writable bits are
+     * updated, as if the accesses had gone through the hierarchy:
+     * misses are passed to the next level, dirty victims are written
+     * back to it, and copies in the other caches above that level are
+     * invalidated or lose write permission. No packets are created
+     * and no latencies computed. Memory is always up to date while
+     * warming, so the blocks get their data only when normal
+     * operation resumes.
+     */
+
+    /** Commands passed between the levels of the hierarchy. */
+    enum WarmCmd {
+        WarmRead,
+        WarmReadEx,
+        WarmWriteback
+    };
+
+    /**
+     * Warm the cache with a CPU access.
+     * @param addr The physical address.
+     * @param is_write Is the access a write?
+     * @param master_id The requestor, for the occupancy statistics.
+     */
+    void
+    warm(Addr addr, bool is_write, MasterID master_id)
+    {
+        warmAccess(blockAlign(addr), is_write ? WarmReadEx : WarmRead,
+                   master_id, NULL);
+    }
+
+    /**
+     * Warm the cache with an access from the CPU or a cache above.
+     * @param blk_addr The block address.
+     * @param cmd The command.
+     * @param master_id The requestor.
+     * @param from The cache above, NULL for a CPU.
+     * @return The BlkWritable and BlkDirty status bits of the copy
+     * given to the requestor.
+     */
+    virtual unsigned warmAccess(Addr blk_addr, WarmCmd cmd,
+                                MasterID master_id, BaseCache *from) = 0;
+
+    /**
+     * Apply a snoop to the copy of a block in this cache.
+     * @param blk_addr The block address.
+     * @param invalidate Invalidate the copy rather than just take away
+     * write permission.
+     * @return True if the cache had a copy.
+     */
+    virtual bool warmSnoop(Addr blk_addr, bool invalidate) = 0;
+
+    /**
+     * Snoop the caches above this one, and the caches above them,
+     * like the bus does for a request from one of them.
+     * @param blk_addr The block address.
+     * @param except The requesting cache, which is not snooped.
+     * @param invalidate Invalidate the copies.
+     * @return True if any of the caches had a copy.
+     */
+    bool warmSnoopUpper(Addr blk_addr, BaseCache *except, bool invalidate);
+
+    /**
+     * Read the data of all blocks allocated while warming from the
+     * memory side.
+     */
+    virtual void fillWarmedBlocks() = 0;
+    /** @} */
+
     virtual bool inCache(Addr addr) const = 0;
 
     virtual bool inMissQueue(Addr addr) const = 0;
@@ -70,7 +70,9 @@ enum CacheBlkStatusBits {
     /** block was referenced */
     BlkReferenced =     0x10,
     /** block was a hardware prefetch yet unaccessed*/
-    BlkHWPrefetched =   0x20
+    BlkHWPrefetched =   0x20,
+    /** block was allocated while warming, its data is not valid */
+    BlkWarmed =         0x40
 };
 
 /**
@@ -254,6 +256,16 @@ class CacheBlk
         return (status & BlkHWPrefetched) != 0;
     }
 
+    /**
+     * Check if this block was allocated while warming the cache and
+     * has not been given its data yet.
+     * @return True if the data of the block is not valid.
+     */
+    bool wasWarmed() const
+    {
+        return (status & BlkWarmed) != 0;
+    }
+
     /**
      * Track the fact that a local locked was issued to the block.  If
      * multiple LLs get issued from the same context we could have
@@ -38,6 +38,7 @@
 
 #include "mem/cache/tags/fa_lru.hh"
 #include "mem/cache/tags/lru.hh"
+#include "mem/cache/tags/packed_tags.hh"
 #include "mem/cache/cache_impl.hh"
 
 // Template Instantiations
@@ -45,5 +46,6 @@
 
 template class Cache<FALRU>;
 template class Cache<LRU>;
+template class Cache<PackedTags>;
 
 #endif //DOXYGEN_SHOULD_SKIP_THIS
@@ -213,8 +213,39 @@ class Cache : public BaseCache
      * the block is not currently in the cache.  Append writebacks if
      * any to provided packet list.  Return free block frame.  May
      * return NULL if there are no replaceable blocks at the moment.
+     * The data is needed by tag stores whose capacity depends on it.
      */
-    BlkType *allocateBlock(Addr addr, PacketList &writebacks);
+    BlkType *allocateBlock(Addr addr, const uint8_t *data,
+                           PacketList &writebacks);
+
+    /**
+     * Check if a block may be replaced, which is not the case while
+     * an upgrade of it is outstanding.
+     */
+    bool isReplaceable(BlkType *blk);
+
+    /**
+     * Evict a valid block that is not a victim of allocateBlock(),
+     * such as another block of a victim sector.
+     * @param blk The block to evict.
+     * @param writebacks List to append the writeback of a dirty block to.
+     */
+    void evictBlock(BlkType *blk, PacketList &writebacks);
+
+    /**
+     * Find a block frame for a new block while warming and insert the
+     * block. Dirty victims are written back to the next level.
+     * @param blk_addr The block address.
+     * @param master_id The requestor.
+     * @return The block, the caller sets its status.
+     */
+    BlkType *warmAllocate(Addr blk_addr, MasterID master_id);
+
+    /**
+     * Pass a block that is evicted while warming to the next level if
+     * it is dirty.
+     */
+    void warmWriteback(BlkType *blk);
 
     /**
      * Populates a cache block and handles all outstanding requests for the
@@ -320,6 +351,14 @@ class Cache : public BaseCache
      */
     bool invalidateVisitor(BlkType &blk);
 
+    /**
+     * Cache block visitor that reads the data of blocks allocated
+     * while warming using functional reads.
+     *
+     * \return Always returns true.
+     */
+    bool fillVisitor(BlkType &blk);
+
     /**
      * Flush a cache line due to an uncacheable memory access to the
      * line.
@@ -410,6 +449,11 @@ class Cache : public BaseCache
 
     void regStats();
 
+    unsigned warmAccess(Addr blk_addr, WarmCmd cmd, MasterID master_id,
+                        BaseCache *from);
+    bool warmSnoop(Addr blk_addr, bool invalidate);
+    void fillWarmedBlocks();
+
     /** serialize the state of the caches
      * We currently don't support checkpointing cache state, so this panics.
      */
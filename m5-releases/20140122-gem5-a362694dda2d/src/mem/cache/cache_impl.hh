@@ -327,7 +327,8 @@ Cache<TagStore>::access(PacketPtr pkt, BlkType *&blk,
         assert(blkSize == pkt->getSize());
         if (blk == NULL) {
             // need to do a replacement
-            blk = allocateBlock(pkt->getAddr(), writebacks);
+            blk = allocateBlock(pkt->getAddr(), pkt->getPtr<uint8_t>(),
+                                writebacks);
             if (blk == NULL) {
                 // no replaceable block available, give up.
                 // writeback will be forwarded to next level.
@@ -336,8 +337,30 @@ Cache<TagStore>::access(PacketPtr pkt, BlkType *&blk,
             }
             tags->insertBlock(pkt, blk);
             blk->status = BlkValid | BlkReadable;
+        } else {
+            // the new data may need more room than the old
+            BlkList extra_victims;
+            tags->findExtraVictims(blk, pkt->getAddr(),
+                                   pkt->getPtr<uint8_t>(), extra_victims);
+            for (typename BlkList::iterator i = extra_victims.begin();
+                 i != extra_victims.end(); ++i) {
+                if (!isReplaceable(*i)) {
+                    // no room, give up and forward the writeback to
+                    // the next level, which leaves our copy stale
+                    tags->invalidate(blk);
+                    blk->invalidate();
+                    blk = NULL;
+                    incMissCount(pkt);
+                    return false;
+                }
+            }
+            for (typename BlkList::iterator i = extra_victims.begin();
+                 i != extra_victims.end(); ++i) {
+                evictBlock(*i, writebacks);
+            }
         }
         std::memcpy(blk->data, pkt->getPtr<uint8_t>(), blkSize);
+        tags->dataWritten(blk);
         blk->status |= BlkDirty;
         if (pkt->isSupplyExclusive()) {
             blk->status |= BlkWritable;
@@ -787,8 +810,9 @@ Cache<TagStore>::functionalAccess(PacketPtr pkt, bool fromCpuSide)
         // shouldn't happen in bypass mode.
         assert(fromCpuSide);
 
-        // The cache should be flushed if we are in cache bypass mode,
-        // so we don't need to check if we need to update anything.
+        // The cache was flushed before entering cache bypass mode and
+        // warming only allocates blocks, memory is up to date, so we
+        // don't need to check if we need to update anything.
         memSidePort->sendFunctional(pkt);
         return;
     }
@@ -806,8 +830,9 @@ Cache<TagStore>::functionalAccess(PacketPtr pkt, bool fromCpuSide)
     // needs to be found.  As a result we always update the request if
     // we have it, but only declare it satisfied if we are the owner.
 
-    // see if we have data at all (owned or otherwise)
-    bool have_data = blk && blk->isValid()
+    // see if we have data at all (owned or otherwise), a block
+    // allocated while warming has none until it is filled
+    bool have_data = blk && blk->isValid() && !blk->wasWarmed()
         && pkt->checkFunctional(&cbpw, blk_addr, blkSize, blk->data);
 
     // data we have is dirty if marked as such or if valid & ownership
@@ -1115,7 +1140,10 @@ template<class TagStore>
 bool
 Cache<TagStore>::writebackVisitor(BlkType &blk)
 {
-    if (blk.isDirty()) {
+    if (blk.isDirty() && blk.wasWarmed()) {
+        // memory is up to date, only the block is not
+        blk.status &= ~BlkDirty;
+    } else if (blk.isDirty()) {
         assert(blk.isValid());
 
         Request request(tags->regenerateBlkAddr(blk.tag, blk.set),
@@ -1149,6 +1177,35 @@ Cache<TagStore>::invalidateVisitor(BlkType &blk)
     return true;
 }
 
+template<class TagStore>
+bool
+Cache<TagStore>::fillVisitor(BlkType &blk)
+{
+    if (blk.isValid() && blk.wasWarmed()) {
+        Request request(tags->regenerateBlkAddr(blk.tag, blk.set),
+                        blkSize, 0, Request::funcMasterId);
+
+        Packet packet(&request, MemCmd::ReadReq);
+        packet.dataStatic(blk.data);
+
+        // caches below ignore the data of their own warmed blocks
+        memSidePort->sendFunctional(&packet);
+
+        blk.status &= ~BlkWarmed;
+        tags->dataWritten(&blk);
+    }
+
+    return true;
+}
+
+template<class TagStore>
+void
+Cache<TagStore>::fillWarmedBlocks()
+{
+    WrappedBlkVisitor visitor(*this, &Cache<TagStore>::fillVisitor);
+    tags->forEachBlk(visitor);
+}
+
 template<class TagStore>
 void
 Cache<TagStore>::uncacheableFlush(PacketPtr pkt)
@@ -1170,37 +1227,216 @@ Cache<TagStore>::uncacheableFlush(PacketPtr pkt)
 
 template<class TagStore>
 typename Cache<TagStore>::BlkType*
-Cache<TagStore>::allocateBlock(Addr addr, PacketList &writebacks)
+Cache<TagStore>::allocateBlock(Addr addr, const uint8_t *data,
+                               PacketList &writebacks)
 {
     BlkType *blk = tags->findVictim(addr, writebacks);
 
-    if (blk->isValid()) {
-        Addr repl_addr = tags->regenerateBlkAddr(blk->tag, blk->set);
-        MSHR *repl_mshr = mshrQueue.findMatch(repl_addr);
-        if (repl_mshr) {
-            // must be an outstanding upgrade request on block
-            // we're about to replace...
-            assert(!blk->isWritable());
-            assert(repl_mshr->needsExclusive());
-            // too hard to replace block with transient state
-            // allocation failed, block not inserted
+    // blocks that have to go as well, e.g. the rest of a sector
+    BlkList extra_victims;
+    tags->findExtraVictims(blk, addr, data, extra_victims);
+
+    // too hard to replace block with transient state
+    // allocation failed, block not inserted
+    if (!isReplaceable(blk))
+        return NULL;
+    for (typename BlkList::iterator i = extra_victims.begin();
+         i != extra_victims.end(); ++i) {
+        if (!isReplaceable(*i))
             return NULL;
+    }
+
+    for (typename BlkList::iterator i = extra_victims.begin();
+         i != extra_victims.end(); ++i) {
+        evictBlock(*i, writebacks);
+    }
+
+    if (blk->isValid()) {
+        DPRINTF(Cache, "replacement: replacing %x with %x: %s\n",
+                tags->regenerateBlkAddr(blk->tag, blk->set), addr,
+                blk->isDirty() ? "writeback" : "clean");
+
+        if (blk->isDirty()) {
+            // Save writeback packet for handling by caller
+            writebacks.push_back(writebackBlk(blk));
+        }
+    }
+
+    return blk;
+}
+
+
+template<class TagStore>
+bool
+Cache<TagStore>::isReplaceable(BlkType *blk)
+{
+    if (!blk->isValid())
+        return true;
+
+    Addr repl_addr = tags->regenerateBlkAddr(blk->tag, blk->set);
+    MSHR *repl_mshr = mshrQueue.findMatch(repl_addr);
+    if (repl_mshr) {
+        // must be an outstanding upgrade request on block
+        // we're about to replace...
+        assert(!blk->isWritable());
+        assert(repl_mshr->needsExclusive());
+        return false;
+    }
+    return true;
+}
+
+
+template<class TagStore>
+void
+Cache<TagStore>::evictBlock(BlkType *blk, PacketList &writebacks)
+{
+    DPRINTF(Cache, "replacement: evicting %x: %s\n",
+            tags->regenerateBlkAddr(blk->tag, blk->set),
+            blk->isDirty() ? "writeback" : "clean");
+
+    if (blk->isDirty()) {
+        // Save writeback packet for handling by caller
+        writebacks.push_back(writebackBlk(blk));
+    }
+    tags->invalidate(blk);
+    blk->invalidate();
+}
+
+
+/////////////////////////////////////////////////////
+//
+// Cache warming
+//
+/////////////////////////////////////////////////////
+
+
+template<class TagStore>
+unsigned
+Cache<TagStore>::warmAccess(Addr blk_addr, WarmCmd cmd, MasterID master_id,
+                            BaseCache *from)
+{
+    Cycles lat;
+    BlkType *blk = tags->accessBlock(blk_addr, lat, -1);
+    warmPending = true;
+
+    if (cmd == WarmWriteback) {
+        // writebacks allocate, as in access(), and come from the
+        // owner of an exclusive copy
+        if (!blk) {
+            blk = warmAllocate(blk_addr, master_id);
+            blk->status = BlkValid | BlkReadable | BlkWritable;
+        }
+        blk->status |= BlkDirty | BlkWarmed;
+        return 0;
+    }
+
+    bool exclusive = cmd == WarmReadEx;
+    // without a next level the bus has no other caches to ask and
+    // memory hands out an exclusive copy
+    unsigned state = 0;
+    if (blk && (blk->isWritable() || !exclusive)) {
+        ++warmHits;
+    } else {
+        ++warmMisses;
+        if (warmNext) {
+            bool shared = warmNext->warmSnoopUpper(blk_addr, this,
+                                                   exclusive);
+            state = warmNext->warmAccess(blk_addr, cmd, master_id, this);
+            if (shared)
+                state &= ~BlkWritable;
         } else {
-            DPRINTF(Cache, "replacement: replacing %x with %x: %s\n",
-                    repl_addr, addr,
-                    blk->isDirty() ? "writeback" : "clean");
+            state = BlkWritable;
+        }
+    }
 
-            if (blk->isDirty()) {
-                // Save writeback packet for handling by caller
-                writebacks.push_back(writebackBlk(blk));
-            }
+    DPRINTF(Cache, "warm %s %x %s\n", exclusive ? "ReadEx" : "Read",
+            blk_addr, blk ? "hit" : "miss");
+
+    if (from && exclusive) {
+        // on ReadExReq we give up our copy unconditionally, a block
+        // we did not have is not allocated just to be given away
+        if (blk) {
+            state |= blk->status & (BlkWritable | BlkDirty);
+            tags->invalidate(blk);
+            blk->invalidate();
         }
+        return state;
     }
 
+    if (!blk) {
+        blk = warmAllocate(blk_addr, master_id);
+        blk->status = BlkValid | BlkReadable | BlkWarmed;
+    }
+    blk->status |= state;
+
+    if (from) {
+        // the dirty copy stays here, as when satisfying a read
+        return blk->status & BlkWritable;
+    }
+
+    if (exclusive)
+        blk->status |= BlkDirty | BlkWarmed;
+    return 0;
+}
+
+
+template<class TagStore>
+bool
+Cache<TagStore>::warmSnoop(Addr blk_addr, bool invalidate)
+{
+    BlkType *blk = tags->findBlock(blk_addr);
+    if (!blk || !blk->isValid())
+        return false;
+
+    if (invalidate) {
+        // the requestor becomes the owner of a dirty copy
+        tags->invalidate(blk);
+        blk->invalidate();
+    } else {
+        blk->status &= ~BlkWritable;
+    }
+    return true;
+}
+
+
+template<class TagStore>
+typename Cache<TagStore>::BlkType*
+Cache<TagStore>::warmAllocate(Addr blk_addr, MasterID master_id)
+{
+    PacketList writebacks;
+    BlkType *blk = tags->findVictim(blk_addr, writebacks);
+    assert(writebacks.empty());
+
+    // the data is not known, the tags have to assume the worst
+    BlkList extra_victims;
+    tags->findExtraVictims(blk, blk_addr, NULL, extra_victims);
+
+    // there are no outstanding requests, so any block can go
+    for (typename BlkList::iterator i = extra_victims.begin();
+         i != extra_victims.end(); ++i) {
+        warmWriteback(*i);
+        tags->invalidate(*i);
+        (*i)->invalidate();
+    }
+
+    if (blk->isValid())
+        warmWriteback(blk);
+    tags->insertBlock(blk_addr, master_id, blk);
     return blk;
 }
 
 
+template<class TagStore>
+void
+Cache<TagStore>::warmWriteback(BlkType *blk)
+{
+    if (blk->isDirty() && warmNext) {
+        warmNext->warmAccess(tags->regenerateBlkAddr(blk->tag, blk->set),
+                             WarmWriteback, Request::wbMasterId, this);
+    }
+}
+
+
 // Note that the reason we return a list of writebacks rather than
 // inserting them directly in the write buffer is that this function
 // is called by both atomic and timing-mode accesses, and in atomic
@@ -1220,7 +1456,7 @@ Cache<TagStore>::handleFill(PacketPtr pkt, BlkType *blk,
         // better have read new data...
         assert(pkt->hasData());
         // need to do a replacement
-        blk = allocateBlock(addr, writebacks);
+        blk = allocateBlock(addr, pkt->getPtr<uint8_t>(), writebacks);
         if (blk == NULL) {
             // No replaceable block... just use temporary storage to
             // complete the current request and then get rid of it
@@ -1265,6 +1501,8 @@ Cache<TagStore>::handleFill(PacketPtr pkt, BlkType *blk,
     // if we got new data, copy it in
     if (pkt->isRead()) {
         std::memcpy(blk->data, pkt->getPtr<uint8_t>(), blkSize);
+        if (blk != tempBlock)
+            tags->dataWritten(blk);
     }
 
     blk->whenReady = clockEdge() + responseLatency * clockPeriod() +
@@ -70,11 +70,63 @@ MSHR::MSHR() : readyTime(0), _isUncacheable(false), downstreamPending(false),
 }
 
 
+Pool MSHR::Target::pool("MSHRTarget", sizeof(Target));
+
 MSHR::TargetList::TargetList()
-    : needsExclusive(false), hasUpgrade(false)
+    : head(NULL), tail(NULL), count(0),
+      needsExclusive(false), hasUpgrade(false)
 {}
 
 
+MSHR::TargetList::~TargetList()
+{
+    while (head)
+        popFront();
+}
+
+
+void
+MSHR::TargetList::popFront()
+{
+    assert(head);
+    Target *t = head;
+    head = t->next;
+    if (!head)
+        tail = NULL;
+    --count;
+    delete t;
+}
+
+
+void
+MSHR::TargetList::splice(TargetList &other)
+{
+    if (!other.head)
+        return;
+
+    if (tail)
+        tail->next = other.head;
+    else
+        head = other.head;
+    tail = other.tail;
+    count += other.count;
+
+    other.head = other.tail = NULL;
+    other.count = 0;
+}
+
+
+void
+MSHR::TargetList::swap(TargetList &other)
+{
+    std::swap(head, other.head);
+    std::swap(tail, other.tail);
+    std::swap(count, other.count);
+    std::swap(needsExclusive, other.needsExclusive);
+    std::swap(hasUpgrade, other.hasUpgrade);
+}
+
+
 inline void
 MSHR::TargetList::add(PacketPtr pkt, Tick readyTime,
                       Counter order, Target::Source source, bool markPending)
@@ -103,7 +155,13 @@ MSHR::TargetList::add(PacketPtr pkt, Tick readyTime,
         }
     }
 
-    push_back(Target(pkt, readyTime, order, source, markPending));
+    Target *t = new Target(pkt, readyTime, order, source, markPending);
+    if (tail)
+        tail->next = t;
+    else
+        head = t;
+    tail = t;
+    ++count;
 }
 
 
@@ -129,9 +187,8 @@ MSHR::TargetList::replaceUpgrades()
     if (!hasUpgrade)
         return;
 
-    Iterator end_i = end();
-    for (Iterator i = begin(); i != end_i; ++i) {
-        replaceUpgrade(i->pkt);
+    for (Target *t = head; t; t = t->next) {
+        replaceUpgrade(t->pkt);
     }
 
     hasUpgrade = false;
@@ -141,16 +198,15 @@ MSHR::TargetList::replaceUpgrades()
 void
 MSHR::TargetList::clearDownstreamPending()
 {
-    Iterator end_i = end();
-    for (Iterator i = begin(); i != end_i; ++i) {
-        if (i->markedPending) {
+    for (Target *t = head; t; t = t->next) {
+        if (t->markedPending) {
             // Iterate over the SenderState stack and see if we find
             // an MSHR entry. If we find one, clear the
             // downstreamPending flag by calling
             // clearDownstreamPending(). This recursively clears the
             // downstreamPending flag in all caches this packet has
             // passed through.
-            MSHR *mshr = i->pkt->findNextSenderState<MSHR>();
+            MSHR *mshr = t->pkt->findNextSenderState<MSHR>();
             if (mshr != NULL) {
                 mshr->clearDownstreamPending();
             }
@@ -162,9 +218,8 @@ MSHR::TargetList::clearDownstreamPending()
 bool
 MSHR::TargetList::checkFunctional(PacketPtr pkt)
 {
-    Iterator end_i = end();
-    for (Iterator i = begin(); i != end_i; ++i) {
-        if (pkt->checkFunctional(i->pkt)) {
+    for (Target *t = head; t; t = t->next) {
+        if (pkt->checkFunctional(t->pkt)) {
             return true;
         }
     }
@@ -177,10 +232,9 @@ void
 MSHR::TargetList::
 print(std::ostream &os, int verbosity, const std::string &prefix) const
 {
-    ConstIterator end_i = end();
-    for (ConstIterator i = begin(); i != end_i; ++i) {
+    for (const Target *t = head; t; t = t->next) {
         const char *s;
-        switch (i->source) {
+        switch (t->source) {
           case Target::FromCPU:
             s = "FromCPU";
             break;
@@ -195,7 +249,7 @@ print(std::ostream &os, int verbosity, const std::string &prefix) const
             break;
         }
         ccprintf(os, "%s%s: ", prefix, s);
-        i->pkt->print(os, verbosity, "");
+        t->pkt->print(os, verbosity, "");
     }
 }
 
@@ -394,7 +448,7 @@ MSHR::promoteDeferredTargets()
     }
 
     // swap targets & deferredTargets lists
-    std::swap(targets, deferredTargets);
+    targets.swap(deferredTargets);
 
     // clear deferredTargets flags
     deferredTargets.resetFlags();
@@ -427,7 +481,7 @@ MSHR::handleFill(Packet *pkt, CacheBlk *blk)
         assert(!downstreamPending);  // not pending here anymore
         deferredTargets.clearDownstreamPending();
         // this clears out deferredTargets too
-        targets.splice(targets.end(), deferredTargets);
+        targets.splice(deferredTargets);
         deferredTargets.resetFlags();
     }
 }
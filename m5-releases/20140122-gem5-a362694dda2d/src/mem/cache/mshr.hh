@@ -50,6 +50,7 @@
 
 #include <list>
 
+#include "base/pool.hh"
 #include "base/printable.hh"
 #include "mem/packet.hh"
 
@@ -91,6 +92,8 @@ class MSHR : public Packet::SenderState, public Printable
 
   public:
 
+    class TargetList;
+
     class Target {
       public:
 
@@ -111,22 +114,75 @@ class MSHR : public Packet::SenderState, public Printable
         Target(PacketPtr _pkt, Tick _readyTime, Counter _order,
                Source _source, bool _markedPending)
             : recvTime(curTick()), readyTime(_readyTime), order(_order),
-              pkt(_pkt), source(_source), markedPending(_markedPending)
+              pkt(_pkt), source(_source), markedPending(_markedPending),
+              next(NULL)
         {}
+
+        /**
+         * A target is allocated for every miss and freed when it is
+         * serviced, so targets come from a pool.
+         * @{
+         */
+        static void *
+        operator new(size_t size)
+        {
+            if (size != sizeof(Target))
+                return ::operator new(size);
+            return pool.allocate();
+        }
+
+        static void
+        operator delete(void *p, size_t size)
+        {
+            if (size != sizeof(Target))
+                ::operator delete(p);
+            else if (p)
+                pool.deallocate(p);
+        }
+        /** @} */
+
+      private:
+        friend class TargetList;
+
+        /** Next target of the list holding this one */
+        Target *next;
+
+        /** Pool of targets, all targets are allocated from it. */
+        static Pool pool;
     };
 
-    class TargetList : public std::list<Target> {
-        /** Target list iterator. */
-        typedef std::list<Target>::iterator Iterator;
-        typedef std::list<Target>::const_iterator ConstIterator;
+    /**
+     * List of targets, linked through the targets themselves so that
+     * adding one takes a single allocation from the target pool.
+     */
+    class TargetList {
+      private:
+        Target *head;
+        Target *tail;
+        int count;
+
+        /** Lists own their targets, they are not copied. */
+        TargetList(const TargetList &);
+        TargetList &operator=(const TargetList &);
 
       public:
         bool needsExclusive;
         bool hasUpgrade;
 
         TargetList();
+        ~TargetList();
         void resetFlags() { needsExclusive = hasUpgrade = false; }
         bool isReset()    { return !needsExclusive && !hasUpgrade; }
+        int size() const { return count; }
+        bool empty() const { return count == 0; }
+        Target &front() { assert(head); return *head; }
+        const Target &front() const { assert(head); return *head; }
+        /** Remove and free the first target. */
+        void popFront();
+        /** Move all targets of other to the end of this list. */
+        void splice(TargetList &other);
+        /** Exchange the targets and flags of two lists. */
+        void swap(TargetList &other);
         void add(PacketPtr pkt, Tick readyTime, Counter order,
                  Target::Source source, bool markPending);
         void replaceUpgrades();
@@ -269,7 +325,7 @@ class MSHR : public Packet::SenderState, public Printable
      */
     void popTarget()
     {
-        targets.pop_front();
+        targets.popFront();
     }
 
     bool isForwardNoResponse() const
@@ -0,0 +1,69 @@
+# Copyright (c) 2014 The Regents of The University of Michigan
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+from m5.params import *
+from m5.SimObject import SimObject
+
+class BaseReplacementPolicy(SimObject):
+    type = 'BaseReplacementPolicy'
+    abstract = True
+    cxx_header = "mem/cache/replacement/base.hh"
+
+class LRUReplacement(BaseReplacementPolicy):
+    type = 'LRUReplacement'
+    cxx_header = "mem/cache/replacement/lru.hh"
+
+class TreePLRUReplacement(BaseReplacementPolicy):
+    type = 'TreePLRUReplacement'
+    cxx_header = "mem/cache/replacement/tree_plru.hh"
+
+class RandomReplacement(BaseReplacementPolicy):
+    type = 'RandomReplacement'
+    cxx_header = "mem/cache/replacement/random.hh"
+
+class LFUReplacement(BaseReplacementPolicy):
+    type = 'LFUReplacement'
+    cxx_header = "mem/cache/replacement/lfu.hh"
+
+class RRIPInsertion(Enum): vals = ['SRRIP', 'BRRIP', 'DRRIP']
+
+class RRIPReplacement(BaseReplacementPolicy):
+    type = 'RRIPReplacement'
+    cxx_header = "mem/cache/replacement/rrip.hh"
+    rrpv_bits = Param.Unsigned(2, "Width of the re-reference prediction "
+                               "values")
+    insertion = Param.RRIPInsertion('SRRIP', "Insertion policy")
+    bimodal_throttle = Param.Unsigned(32, "BRRIP inserts at long once "
+                                      "every this many fills")
+    leader_sets = Param.Unsigned(32, "DRRIP leader sets of each policy")
+    psel_bits = Param.Unsigned(10, "Width of the DRRIP policy selection "
+                               "counter")
+
+class BRRIPReplacement(RRIPReplacement):
+    insertion = 'BRRIP'
+
+class DRRIPReplacement(RRIPReplacement):
+    insertion = 'DRRIP'
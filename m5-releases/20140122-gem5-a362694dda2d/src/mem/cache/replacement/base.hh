@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Declaration of the interface between tag stores and replacement
+ * policies.
+ */
+
+#ifndef __MEM_CACHE_REPLACEMENT_BASE_HH__
+#define __MEM_CACHE_REPLACEMENT_BASE_HH__
+
+#include "params/BaseReplacementPolicy.hh"
+#include "sim/sim_object.hh"
+
+/**
+ * A replacement policy for a set associative tag store. The tag store
+ * tells the policy about every hit, fill and invalidation of a way and
+ * asks it for a victim among a set of valid candidate ways. Policies
+ * keep their state per set and way in packed arrays of their own, so
+ * the tag store does not need any per-block replacement fields.
+ */
+class BaseReplacementPolicy : public SimObject
+{
+  protected:
+    /** The number of sets in the tag store. */
+    unsigned numSets;
+    /** The associativity of the tag store. */
+    unsigned assoc;
+
+  public:
+    typedef BaseReplacementPolicyParams Params;
+
+    BaseReplacementPolicy(const Params *p);
+
+    virtual ~BaseReplacementPolicy() {}
+
+    /**
+     * Size the policy state. Called once by the tag store using the
+     * policy, before any other call.
+     * @param num_sets The number of sets.
+     * @param assoc The associativity.
+     */
+    virtual void setGeometry(unsigned num_sets, unsigned assoc);
+
+    /**
+     * A way was hit by an access.
+     * @param set The set.
+     * @param way The way that was hit.
+     */
+    virtual void touch(unsigned set, unsigned way) = 0;
+
+    /**
+     * A block was brought into a way after a miss.
+     * @param set The set.
+     * @param way The way that was filled.
+     */
+    virtual void insert(unsigned set, unsigned way) = 0;
+
+    /**
+     * The block in a way was invalidated.
+     * @param set The set.
+     * @param way The way that was invalidated.
+     */
+    virtual void invalidate(unsigned set, unsigned way) = 0;
+
+    /**
+     * Choose the way to evict from a set. Usually all ways are valid
+     * candidates, but a tag store that evicts several blocks at once
+     * leaves out the ways it already picked.
+     * @param set The set.
+     * @param candidates A mask of the valid ways that may be chosen,
+     * never empty.
+     * @return The way to evict.
+     */
+    virtual unsigned victim(unsigned set, uint64_t candidates) = 0;
+};
+
+#endif // __MEM_CACHE_REPLACEMENT_BASE_HH__
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Definitions of the LRU replacement policy.
+ */
+
+#include "base/bitfield.hh"
+#include "base/misc.hh"
+#include "mem/cache/replacement/lru.hh"
+
+LRUReplacement::LRUReplacement(const Params *p)
+    : BaseReplacementPolicy(p)
+{
+}
+
+void
+LRUReplacement::setGeometry(unsigned num_sets, unsigned _assoc)
+{
+    BaseReplacementPolicy::setGeometry(num_sets, _assoc);
+    if (assoc > 256)
+        fatal("%s: LRU replacement supports up to 256 ways\n", name());
+
+    // start with way 0 as the most recently used
+    ages.resize(numSets * assoc);
+    for (unsigned i = 0; i < numSets; ++i)
+        for (unsigned j = 0; j < assoc; ++j)
+            ages[i * assoc + j] = j;
+}
+
+void
+LRUReplacement::touch(unsigned set, unsigned way)
+{
+    uint8_t *set_ages = &ages[set * assoc];
+    uint8_t age = set_ages[way];
+
+    // every way more recent than this one ages by one
+    for (unsigned i = 0; i < assoc; ++i)
+        set_ages[i] += set_ages[i] < age;
+    set_ages[way] = 0;
+}
+
+void
+LRUReplacement::invalidate(unsigned set, unsigned way)
+{
+    uint8_t *set_ages = &ages[set * assoc];
+    uint8_t age = set_ages[way];
+
+    for (unsigned i = 0; i < assoc; ++i)
+        set_ages[i] -= set_ages[i] > age;
+    set_ages[way] = assoc - 1;
+}
+
+unsigned
+LRUReplacement::victim(unsigned set, uint64_t candidates)
+{
+    const uint8_t *set_ages = &ages[set * assoc];
+    unsigned way = findLsbSet(candidates);
+    for (candidates &= candidates - 1; candidates;
+         candidates &= candidates - 1) {
+        unsigned i = findLsbSet(candidates);
+        if (set_ages[i] > set_ages[way])
+            way = i;
+    }
+    return way;
+}
+
+LRUReplacement *
+LRUReplacementParams::create()
+{
+    return new LRUReplacement(this);
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Definitions of the random replacement policy.
+ */
+
+#include "base/bitfield.hh"
+#include "base/random.hh"
+#include "mem/cache/replacement/random.hh"
+
+RandomReplacement::RandomReplacement(const Params *p)
+    : BaseReplacementPolicy(p)
+{
+}
+
+unsigned
+RandomReplacement::victim(unsigned set, uint64_t candidates)
+{
+    if (candidates == mask(assoc))
+        return random_mt.random<unsigned>(0, assoc - 1);
+
+    unsigned count = 0;
+    for (uint64_t c = candidates; c; c &= c - 1)
+        ++count;
+    for (unsigned n = random_mt.random<unsigned>(0, count - 1); n; --n)
+        candidates &= candidates - 1;
+    return findLsbSet(candidates);
+}
+
+RandomReplacement *
+RandomReplacementParams::create()
+{
+    return new RandomReplacement(this);
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Declaration of the random replacement policy.
+ */
+
+#ifndef __MEM_CACHE_REPLACEMENT_RANDOM_HH__
+#define __MEM_CACHE_REPLACEMENT_RANDOM_HH__
+
+#include "mem/cache/replacement/base.hh"
+#include "params/RandomReplacement.hh"
+
+/**
+ * Random replacement. It keeps no state; the victim is drawn from
+ * the simulator's random number generator, so runs are repeatable.
+ */
+class RandomReplacement : public BaseReplacementPolicy
+{
+  public:
+    typedef RandomReplacementParams Params;
+
+    RandomReplacement(const Params *p);
+
+    void touch(unsigned set, unsigned way) {}
+    void insert(unsigned set, unsigned way) {}
+    void invalidate(unsigned set, unsigned way) {}
+    unsigned victim(unsigned set, uint64_t candidates);
+};
+
+#endif // __MEM_CACHE_REPLACEMENT_RANDOM_HH__
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Definitions of the re-reference interval prediction policies.
+ */
+
+#include <algorithm>
+
+#include "base/bitfield.hh"
+#include "base/misc.hh"
+#include "base/random.hh"
+#include "mem/cache/replacement/rrip.hh"
+
+RRIPReplacement::RRIPReplacement(const Params *p)
+    : BaseReplacementPolicy(p), maxRRPV((1 << p->rrpv_bits) - 1),
+      insertion(p->insertion), bimodalThrottle(p->bimodal_throttle),
+      leaderSets(p->leader_sets), pselBits(p->psel_bits)
+{
+    if (p->rrpv_bits < 1 || p->rrpv_bits > 8)
+        fatal("%s: RRPVs must be 1 to 8 bits wide\n", name());
+    if (!bimodalThrottle)
+        fatal("%s: bimodal_throttle must be greater than zero\n", name());
+    if (pselBits < 1 || pselBits > 31)
+        fatal("%s: psel_bits must be 1 to 31\n", name());
+}
+
+void
+RRIPReplacement::setGeometry(unsigned num_sets, unsigned _assoc)
+{
+    BaseReplacementPolicy::setGeometry(num_sets, _assoc);
+    rrpvs.assign(numSets * assoc, maxRRPV);
+    duel.init(numSets, leaderSets, pselBits);
+}
+
+void
+RRIPReplacement::insert(unsigned set, unsigned way)
+{
+    bool bimodal = false;
+    switch (insertion) {
+      case Enums::SRRIP:
+        break;
+      case Enums::BRRIP:
+        bimodal = true;
+        break;
+      case Enums::DRRIP:
+        // every fill follows a miss
+        duel.miss(set);
+        bimodal = duel.policy(set) == 1;
+        break;
+      default:
+        panic("unknown RRIP insertion policy\n");
+    }
+
+    uint8_t rrpv = maxRRPV - 1;
+    if (bimodal && random_mt.random<unsigned>(0, bimodalThrottle - 1))
+        rrpv = maxRRPV;
+    rrpvs[set * assoc + way] = rrpv;
+}
+
+unsigned
+RRIPReplacement::victim(unsigned set, uint64_t candidates)
+{
+    uint8_t *set_rrpvs = &rrpvs[set * assoc];
+
+    unsigned way = findLsbSet(candidates);
+    for (candidates &= candidates - 1; candidates;
+         candidates &= candidates - 1) {
+        unsigned i = findLsbSet(candidates);
+        if (set_rrpvs[i] > set_rrpvs[way])
+            way = i;
+    }
+
+    // age the set at once as far as repeated single steps would have;
+    // ways that were not candidates may already be at the maximum
+    uint8_t shortfall = maxRRPV - set_rrpvs[way];
+    if (shortfall) {
+        for (unsigned i = 0; i < assoc; ++i)
+            set_rrpvs[i] = std::min<unsigned>(set_rrpvs[i] + shortfall,
+                                              maxRRPV);
+    }
+    return way;
+}
+
+RRIPReplacement *
+RRIPReplacementParams::create()
+{
+    return new RRIPReplacement(this);
+}
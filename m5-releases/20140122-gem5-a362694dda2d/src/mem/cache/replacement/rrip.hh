@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Declaration of the re-reference interval prediction policies.
+ */
+
+#ifndef __MEM_CACHE_REPLACEMENT_RRIP_HH__
+#define __MEM_CACHE_REPLACEMENT_RRIP_HH__
+
+#include <vector>
+
+#include "enums/RRIPInsertion.hh"
+#include "mem/cache/replacement/base.hh"
+#include "mem/cache/replacement/set_dueling.hh"
+#include "params/RRIPReplacement.hh"
+
+/**
+ * Re-reference interval prediction (Jaleel et al., ISCA 2010). Every
+ * way has a small re-reference prediction value (RRPV); a hit sets it
+ * to 0, and the victim is a way with the largest value, after ageing
+ * the whole set until one reaches the maximum ("distant").
+ *
+ * The insertion policy decides the RRPV of a new block:
+ *  - SRRIP inserts at "long", one below distant.
+ *  - BRRIP inserts at distant, and at long once every
+ *    bimodal_throttle fills, which protects the cache from scans.
+ *  - DRRIP picks between SRRIP and BRRIP by set dueling.
+ */
+class RRIPReplacement : public BaseReplacementPolicy
+{
+  protected:
+    /** The RRPV of every way, assoc per set. */
+    std::vector<uint8_t> rrpvs;
+
+    /** The largest RRPV, "distant". */
+    const uint8_t maxRRPV;
+
+    /** The insertion policy. */
+    const Enums::RRIPInsertion insertion;
+
+    /** BRRIP inserts at long once every this many fills. */
+    const unsigned bimodalThrottle;
+
+    /** Leader sets of each policy for DRRIP. */
+    const unsigned leaderSets;
+
+    /** Width of the DRRIP policy selection counter. */
+    const unsigned pselBits;
+
+    /** DRRIP duel between SRRIP (0) and BRRIP (1). */
+    SetDueling duel;
+
+  public:
+    typedef RRIPReplacementParams Params;
+
+    RRIPReplacement(const Params *p);
+
+    void setGeometry(unsigned num_sets, unsigned assoc);
+
+    void touch(unsigned set, unsigned way) { rrpvs[set * assoc + way] = 0; }
+    void insert(unsigned set, unsigned way);
+
+    void
+    invalidate(unsigned set, unsigned way)
+    {
+        rrpvs[set * assoc + way] = maxRRPV;
+    }
+
+    unsigned victim(unsigned set, uint64_t candidates);
+};
+
+#endif // __MEM_CACHE_REPLACEMENT_RRIP_HH__
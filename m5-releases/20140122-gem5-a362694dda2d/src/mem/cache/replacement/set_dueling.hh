@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Declaration of set dueling between two replacement policies.
+ */
+
+#ifndef __MEM_CACHE_REPLACEMENT_SET_DUELING_HH__
+#define __MEM_CACHE_REPLACEMENT_SET_DUELING_HH__
+
+#include <algorithm>
+
+/**
+ * Set dueling chooses at run time between two policies, 0 and 1. A
+ * few leader sets always use policy 0 and as many always use policy
+ * 1; a saturating counter goes up on a miss in a policy 0 leader and
+ * down on a miss in a policy 1 leader. All other sets follow the
+ * policy that is missing less.
+ *
+ * The sets are split into constituencies of equal size, each with one
+ * leader of either policy, picked by complement select so that the
+ * leaders do not all map to the same set index bits.
+ */
+class SetDueling
+{
+  private:
+    /** Sets per constituency, 0 if there are no leaders. */
+    unsigned stride;
+    /** Saturation value of the counter. */
+    unsigned pselMax;
+    /** The policy selection counter. */
+    unsigned psel;
+
+    /** The policy a set leads, or -1 for a follower set. */
+    int
+    leaderOf(unsigned set) const
+    {
+        if (!stride)
+            return -1;
+        unsigned offset = set % stride;
+        unsigned constituency = (set / stride) % stride;
+        if (offset == constituency)
+            return 0;
+        if (offset == stride - 1 - constituency)
+            return 1;
+        return -1;
+    }
+
+  public:
+    SetDueling()
+        : stride(0), pselMax(0), psel(0)
+    {}
+
+    /**
+     * @param num_sets The number of sets, a power of two.
+     * @param leader_sets The number of leader sets of each policy.
+     * @param psel_bits The width of the selection counter.
+     */
+    void
+    init(unsigned num_sets, unsigned leader_sets, unsigned psel_bits)
+    {
+        stride = 0;
+        if (num_sets >= 2 && leader_sets)
+            stride = std::max(num_sets / leader_sets, 2U);
+        pselMax = (1U << psel_bits) - 1;
+        psel = pselMax / 2;
+    }
+
+    /** @return The policy a set uses, 0 or 1. */
+    unsigned
+    policy(unsigned set) const
+    {
+        int leader = leaderOf(set);
+        if (leader >= 0)
+            return leader;
+        return psel > pselMax / 2;
+    }
+
+    /** Count a miss in a set. */
+    void
+    miss(unsigned set)
+    {
+        int leader = leaderOf(set);
+        if (leader == 0 && psel < pselMax)
+            ++psel;
+        else if (leader == 1 && psel > 0)
+            --psel;
+    }
+};
+
+#endif // __MEM_CACHE_REPLACEMENT_SET_DUELING_HH__
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Definitions of the tree pseudo-LRU replacement policy.
+ */
+
+#include "base/bitfield.hh"
+#include "base/intmath.hh"
+#include "base/misc.hh"
+#include "mem/cache/replacement/tree_plru.hh"
+
+TreePLRUReplacement::TreePLRUReplacement(const Params *p)
+    : BaseReplacementPolicy(p), depth(0)
+{
+}
+
+void
+TreePLRUReplacement::setGeometry(unsigned num_sets, unsigned _assoc)
+{
+    BaseReplacementPolicy::setGeometry(num_sets, _assoc);
+    if (!isPowerOf2(assoc) || assoc > 64)
+        fatal("%s: tree PLRU needs a power of two associativity up to "
+              "64\n", name());
+
+    depth = floorLog2(assoc);
+    trees.assign(numSets, 0);
+}
+
+void
+TreePLRUReplacement::touch(unsigned set, unsigned way)
+{
+    uint64_t &tree = trees[set];
+    unsigned node = 0;
+    for (int level = depth - 1; level >= 0; --level) {
+        uint64_t right = (way >> level) & 1;
+        // point to the other half
+        tree = (tree & ~(ULL(1) << node)) | ((right ^ 1) << node);
+        node = 2 * node + 1 + right;
+    }
+}
+
+void
+TreePLRUReplacement::invalidate(unsigned set, unsigned way)
+{
+    uint64_t &tree = trees[set];
+    unsigned node = 0;
+    for (int level = depth - 1; level >= 0; --level) {
+        uint64_t right = (way >> level) & 1;
+        // point to this way
+        tree = (tree & ~(ULL(1) << node)) | (right << node);
+        node = 2 * node + 1 + right;
+    }
+}
+
+unsigned
+TreePLRUReplacement::victim(unsigned set, uint64_t candidates)
+{
+    uint64_t tree = trees[set];
+    unsigned node = 0;
+    unsigned way = 0;
+    for (unsigned level = 0; level < depth; ++level) {
+        unsigned right = (tree >> node) & 1;
+        // go the other way if the half pointed to has no candidates
+        unsigned span = 1 << (depth - level - 1);
+        unsigned first = ((way << 1) | right) * span;
+        if (!bits(candidates, first + span - 1, first))
+            right ^= 1;
+        way = (way << 1) | right;
+        node = 2 * node + 1 + right;
+    }
+    return way;
+}
+
+TreePLRUReplacement *
+TreePLRUReplacementParams::create()
+{
+    return new TreePLRUReplacement(this);
+}
@@ -38,6 +38,7 @@
 from m5.params import *
 from m5.proxy import *
 from ClockedObject import ClockedObject
+from ReplacementPolicies import LRUReplacement
 
 class BaseTags(ClockedObject):
     type = 'BaseTags'
@@ -59,6 +60,17 @@ class LRU(BaseTags):
     cxx_header = "mem/cache/tags/lru.hh"
     assoc = Param.Int(Parent.assoc, "associativity")
 
+class PackedTags(BaseTags):
+    type = 'PackedTags'
+    cxx_class = 'PackedTags'
+    cxx_header = "mem/cache/tags/packed_tags.hh"
+    assoc = Param.Int(Parent.assoc, "associativity")
+    replacement_policy = Param.BaseReplacementPolicy(LRUReplacement(),
+        "Replacement policy")
+    sectors = Param.Unsigned(1, "Number of consecutive blocks sharing a tag")
+    compression = Param.Bool(False, "Compress blocks with BDI, holding up "
+                             "to twice assoc blocks per set")
+
 class FALRU(BaseTags):
     type = 'FALRU'
     cxx_class = 'FALRU'
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Definitions of the Base-Delta-Immediate compressed size of a block.
+ */
+
+#include "mem/cache/tags/bdi.hh"
+
+namespace {
+
+/** Read a little endian value of the given size */
+inline uint64_t
+load(const uint8_t *p, unsigned bytes)
+{
+    uint64_t value = 0;
+    for (unsigned i = bytes; i > 0; --i)
+        value = (value << 8) | p[i - 1];
+    return value;
+}
+
+/** Whether a value of value_bytes is a sign extended delta_bytes one */
+inline bool
+fits(uint64_t value, unsigned value_bytes, unsigned delta_bytes)
+{
+    unsigned shift = 64 - 8 * value_bytes;
+    int64_t v = (int64_t)(value << shift) >> shift;
+    int64_t limit = (int64_t)1 << (8 * delta_bytes - 1);
+    return v >= -limit && v < limit;
+}
+
+/**
+ * Whether every value of a block is within delta_bytes of zero or of
+ * a common base.
+ */
+bool
+encodable(const uint8_t *data, unsigned size, unsigned value_bytes,
+          unsigned delta_bytes)
+{
+    bool have_base = false;
+    uint64_t base = 0;
+    for (unsigned i = 0; i < size; i += value_bytes) {
+        uint64_t value = load(data + i, value_bytes);
+        if (fits(value, value_bytes, delta_bytes))
+            continue;
+        if (!have_base) {
+            base = value;
+            have_base = true;
+        } else if (!fits(value - base, value_bytes, delta_bytes)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+namespace BDI {
+
+unsigned
+compressedSize(const uint8_t *data, unsigned size)
+{
+    static const unsigned encodings[][2] = {
+        // value bytes, delta bytes, in order of the compressed size
+        // of a 64-byte block
+        { 8, 1 }, { 4, 1 }, { 8, 2 }, { 2, 1 }, { 4, 2 }, { 8, 4 },
+    };
+
+    uint64_t first = load(data, 8);
+    bool repeated = true;
+    for (unsigned i = 8; i < size && repeated; i += 8)
+        repeated = load(data + i, 8) == first;
+    if (repeated)
+        return first == 0 ? 1 : 8;
+
+    unsigned best = size;
+    for (unsigned e = 0; e < sizeof(encodings) / sizeof(encodings[0]);
+         ++e) {
+        unsigned value_bytes = encodings[e][0];
+        unsigned delta_bytes = encodings[e][1];
+        unsigned values = size / value_bytes;
+        unsigned encoded =
+            value_bytes + values * delta_bytes + (values + 7) / 8;
+        if (encoded < best &&
+            encodable(data, size, value_bytes, delta_bytes)) {
+            best = encoded;
+        }
+    }
+    return best;
+}
+
+} // namespace BDI
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Declaration of the Base-Delta-Immediate compressed size of a block.
+ */
+
+#ifndef __MEM_CACHE_TAGS_BDI_HH__
+#define __MEM_CACHE_TAGS_BDI_HH__
+
+#include "base/types.hh"
+
+namespace BDI {
+
+/**
+ * The size of a block compressed with Base-Delta-Immediate
+ * compression (Pekhimenko et al., PACT 2012). A block of all zeros
+ * takes one byte and a block repeating one 8-byte value takes eight.
+ * Otherwise the block is split into 8, 4 or 2 byte values, each of
+ * which is stored as a 1, 2 or 4 byte delta from either zero or the
+ * first value that is not close to zero, plus one bit per value to
+ * tell the two bases apart. The smallest of these encodings is used,
+ * or the block is left uncompressed if none of them fits.
+ *
+ * Only the size is computed; the simulator keeps the data
+ * uncompressed.
+ * @param data The block.
+ * @param size The block size in bytes, a multiple of 8.
+ * @return The compressed size in bytes, at most size.
+ */
+unsigned compressedSize(const uint8_t *data, unsigned size);
+
+} // namespace BDI
+
+#endif // __MEM_CACHE_TAGS_BDI_HH__
@@ -245,7 +245,7 @@ FALRU::findVictim(Addr addr, PacketList &writebacks)
 }
 
 void
-FALRU::insertBlock(PacketPtr pkt, FALRU::BlkType *blk)
+FALRU::insertBlock(Addr addr, MasterID master_id, FALRU::BlkType *blk)
 {
 }
 
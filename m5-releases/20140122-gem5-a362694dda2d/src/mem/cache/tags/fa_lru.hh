@@ -205,7 +205,26 @@ public:
      */
     FALRUBlk* findVictim(Addr addr, PacketList & writebacks);
 
-    void insertBlock(PacketPtr pkt, BlkType *blk);
+    /**
+     * Find the blocks to evict along with a victim, none in this tag
+     * store.
+     */
+    void findExtraVictims(BlkType *blk, Addr addr, const uint8_t *data,
+                          BlkList &victims)
+    {
+    }
+
+    void insertBlock(PacketPtr pkt, BlkType *blk)
+    {
+        insertBlock(pkt->getAddr(), pkt->req->masterId(), blk);
+    }
+
+    void insertBlock(Addr addr, MasterID master_id, BlkType *blk);
+
+    /**
+     * Note that the data of a block was written, nothing to do here.
+     */
+    void dataWritten(BlkType *blk) {}
 
     /**
      * Return the hit latency of this cache.
@@ -172,10 +172,8 @@ LRU::findVictim(Addr addr, PacketList &writebacks)
 }
 
 void
-LRU::insertBlock(PacketPtr pkt, BlkType *blk)
+LRU::insertBlock(Addr addr, MasterID master_id, BlkType *blk)
 {
-    Addr addr = pkt->getAddr();
-    MasterID master_id = pkt->req->masterId();
     if (!blk->isTouched) {
         tagsInUse++;
         blk->isTouched = true;
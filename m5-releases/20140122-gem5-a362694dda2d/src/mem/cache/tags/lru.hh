@@ -169,13 +169,39 @@ public:
      */
     BlkType* findVictim(Addr addr, PacketList &writebacks);
 
+    /**
+     * Find the blocks to evict along with a victim, none in this tag
+     * store.
+     */
+    void findExtraVictims(BlkType *blk, Addr addr, const uint8_t *data,
+                          BlkList &victims)
+    {
+    }
+
     /**
      * Insert the new block into the cache.  For LRU this means inserting into
      * the MRU position of the set.
      * @param pkt Packet holding the address to update
      * @param blk The block to update.
      */
-     void insertBlock(PacketPtr pkt, BlkType *blk);
+    void insertBlock(PacketPtr pkt, BlkType *blk)
+    {
+        insertBlock(pkt->getAddr(), pkt->req->masterId(), blk);
+    }
+
+    /**
+     * Insert the new block into the cache without a packet, as done
+     * when warming the cache.
+     * @param addr The address of the block.
+     * @param master_id The requestor bringing in the block.
+     * @param blk The block to update.
+     */
+    void insertBlock(Addr addr, MasterID master_id, BlkType *blk);
+
+    /**
+     * Note that the data of a block was written, nothing to do here.
+     */
+    void dataWritten(BlkType *blk) {}
 
     /**
      * Generate the tag from the given address.
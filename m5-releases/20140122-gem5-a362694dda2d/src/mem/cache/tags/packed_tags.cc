@@ -0,0 +1,469 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Definitions of the packed tag store.
+ */
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <string>
+
+#include "base/bitfield.hh"
+#include "base/intmath.hh"
+#include "debug/Cache.hh"
+#include "debug/CacheRepl.hh"
+#include "mem/cache/tags/bdi.hh"
+#include "mem/cache/tags/packed_tags.hh"
+#include "mem/cache/base.hh"
+#include "sim/core.hh"
+
+using namespace std;
+
+namespace {
+
+/** Tags compared by one SIMD instruction */
+#if defined(__AVX2__)
+const unsigned vectorTags = 4;
+#elif defined(__SSE2__)
+const unsigned vectorTags = 2;
+#else
+const unsigned vectorTags = 1;
+#endif
+
+/**
+ * Compare the tags of a set to a tag.
+ * @param tags The tags, a multiple of vectorTags.
+ * @return A mask with bit i set if tag i matches.
+ */
+inline uint64_t
+matchTags(const Addr *tags, unsigned count, Addr tag)
+{
+    uint64_t matches = 0;
+#if defined(__AVX2__)
+    const __m256i key = _mm256_set1_epi64x(tag);
+    for (unsigned i = 0; i < count; i += vectorTags) {
+        __m256i t = _mm256_loadu_si256((const __m256i *)(tags + i));
+        __m256i eq = _mm256_cmpeq_epi64(t, key);
+        uint64_t bits = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+        matches |= bits << i;
+    }
+#elif defined(__SSE2__)
+    // SSE2 has no 64-bit compare, so and the two 32-bit halves
+    const __m128i key = _mm_set1_epi64x(tag);
+    for (unsigned i = 0; i < count; i += vectorTags) {
+        __m128i t = _mm_loadu_si128((const __m128i *)(tags + i));
+        __m128i eq = _mm_cmpeq_epi32(t, key);
+        eq = _mm_and_si128(eq,
+                           _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        uint64_t bits = _mm_movemask_pd(_mm_castsi128_pd(eq));
+        matches |= bits << i;
+    }
+#else
+    for (unsigned i = 0; i < count; ++i)
+        matches |= (uint64_t)(tags[i] == tag) << i;
+#endif
+    return matches;
+}
+
+} // anonymous namespace
+
+const unsigned PackedTags::MaxAssoc;
+const Addr PackedTags::invalidTag;
+const unsigned PackedTags::segmentSize;
+
+PackedTags::PackedTags(const Params *p)
+    : BaseTags(p), assoc(p->assoc), sectors(p->sectors),
+      compression(p->compression),
+      numWays(p->compression ? 2 * p->assoc : p->assoc),
+      numSets(p->size / (p->block_size * p->sectors * p->assoc)),
+      setStride(roundUp(numWays, vectorTags)),
+      replacementPolicy(p->replacement_policy),
+      setCapacity(p->assoc * p->block_size)
+{
+    // Check parameters
+    if (blkSize < 4 || !isPowerOf2(blkSize)) {
+        fatal("Block size must be at least 4 and a power of 2");
+    }
+    if (numSets <= 0 || !isPowerOf2(numSets)) {
+        fatal("# of sets must be non-zero and a power of 2");
+    }
+    if (numWays <= 0 || numWays > MaxAssoc) {
+        fatal("associativity must be between 1 and %d, or half that "
+              "with compression", MaxAssoc);
+    }
+    if (sectors <= 0 || !isPowerOf2(sectors)) {
+        fatal("# of blocks in a sector must be non-zero and a power of 2");
+    }
+    if (compression && sectors > 1) {
+        fatal("Compressed sectors are not supported");
+    }
+    if (compression && blkSize < 8) {
+        fatal("Block size must be at least 8 for compression");
+    }
+    if (hitLatency <= 0) {
+        fatal("access latency must be greater than zero");
+    }
+
+    blkMask = blkSize - 1;
+    blkShift = floorLog2(blkSize);
+    sectorBits = floorLog2(sectors);
+    setShift = blkShift + sectorBits;
+    setMask = numSets - 1;
+    tagShift = setShift + floorLog2(numSets);
+    warmedUp = false;
+    /** @todo Make warmup percentage a parameter. */
+    warmupBound = numSets * assoc * sectors;
+
+    numBlocks = numSets * numWays * sectors;
+    blks = new BlkType[numBlocks];
+    // allocate data storage in one big chunk
+    dataBlks = new uint8_t[numBlocks * blkSize];
+    tags = new Addr[numSets * setStride];
+    if (compression) {
+        compressedSizes.resize(numSets * numWays, 0);
+        setBytes.resize(numSets, 0);
+    }
+
+    for (unsigned i = 0; i < numSets; ++i) {
+        for (unsigned j = 0; j < setStride; ++j)
+            tags[i * setStride + j] = invalidTag;
+
+        for (unsigned j = 0; j < numWays * sectors; ++j) {
+            unsigned blkIndex = i * numWays * sectors + j;
+            BlkType *blk = &blks[blkIndex];
+            blk->data = &dataBlks[blkSize * blkIndex];
+
+            // invalidate new cache block
+            blk->invalidate();
+
+            blk->tag = j;
+            blk->whenReady = 0;
+            blk->isTouched = false;
+            blk->size = blkSize;
+            blk->set = i;
+        }
+    }
+
+    replacementPolicy->setGeometry(numSets, numWays);
+}
+
+PackedTags::~PackedTags()
+{
+    delete [] tags;
+    delete [] dataBlks;
+    delete [] blks;
+}
+
+void
+PackedTags::regStats()
+{
+    BaseTags::regStats();
+
+    using namespace Stats;
+
+    dataSizes
+        .init(0, blkSize, segmentSize)
+        .name(name() + ".data_sizes")
+        .desc("Compressed size of the data written to blocks")
+        .flags(nozero | pdf)
+        ;
+}
+
+uint64_t
+PackedTags::matchingWays(unsigned set, Addr sector_tag) const
+{
+    return matchTags(&tags[set * setStride], setStride, sector_tag);
+}
+
+int
+PackedTags::findWay(unsigned set, Addr tag) const
+{
+    uint64_t matches = matchingWays(set, tag >> sectorBits);
+
+    // The cache may invalidate a block without telling the tag store,
+    // so check the block itself; a stale tag can only be a false
+    // candidate, never a missed block.
+    while (matches) {
+        int way = findLsbSet(matches);
+        if (blkAt(set, way, sectorOf(tag))->isValid())
+            return way;
+        matches &= matches - 1;
+    }
+    return -1;
+}
+
+PackedTags::BlkType*
+PackedTags::accessBlock(Addr addr, Cycles &lat, int master_id)
+{
+    Addr tag = extractTag(addr);
+    unsigned set = extractSet(addr);
+    int way = findWay(set, tag);
+    lat = hitLatency;
+    if (way < 0)
+        return NULL;
+
+    BlkType *blk = blkAt(set, way, sectorOf(tag));
+    replacementPolicy->touch(set, way);
+    DPRINTF(CacheRepl, "set %x: touching blk %x in way %d\n",
+            set, regenerateBlkAddr(tag, set), way);
+    if (blk->whenReady > curTick()
+        && cache->ticksToCycles(blk->whenReady - curTick()) > hitLatency) {
+        lat = cache->ticksToCycles(blk->whenReady - curTick());
+    }
+    blk->refCount += 1;
+
+    return blk;
+}
+
+PackedTags::BlkType*
+PackedTags::findBlock(Addr addr) const
+{
+    Addr tag = extractTag(addr);
+    unsigned set = extractSet(addr);
+    int way = findWay(set, tag);
+    return way < 0 ? NULL : blkAt(set, way, sectorOf(tag));
+}
+
+PackedTags::BlkType*
+PackedTags::findVictim(Addr addr, PacketList &writebacks)
+{
+    Addr tag = extractTag(addr);
+    unsigned set = extractSet(addr);
+
+    // a block whose sector is present goes into the sector's way,
+    // otherwise fill an invalid way if there is one
+    uint64_t present = matchingWays(set, tag >> sectorBits);
+    uint64_t invalid = ~validWays(set) & mask(numWays);
+    unsigned way;
+    if (present)
+        way = findLsbSet(present);
+    else if (invalid)
+        way = findLsbSet(invalid);
+    else
+        way = replacementPolicy->victim(set, mask(numWays));
+    BlkType *blk = blkAt(set, way, sectorOf(tag));
+
+    if (blk->isValid()) {
+        DPRINTF(CacheRepl, "set %x: selecting blk %x for replacement\n",
+                set, regenerateBlkAddr(blk->tag, set));
+    }
+    return blk;
+}
+
+void
+PackedTags::findExtraVictims(BlkType *blk, Addr addr, const uint8_t *data,
+                             BlkList &victims)
+{
+    unsigned set = blk->set;
+    unsigned way = wayOf(blk);
+    Addr sector_tag = addr >> tagShift;
+
+    if (tags[set * setStride + way] != sector_tag) {
+        // the sector in the way is replaced as a whole
+        for (unsigned i = 0; i < sectors; ++i) {
+            BlkType *other = blkAt(set, way, i);
+            if (other != blk && other->isValid())
+                victims.push_back(other);
+        }
+    }
+
+    if (!compression)
+        return;
+
+    // the new data replaces whatever the block holds now, data that is
+    // not known yet is taken to be incompressible
+    unsigned need = data ?
+        roundUp(BDI::compressedSize(data, blkSize), segmentSize) : blkSize;
+    unsigned used = setBytes[set] - compressedSizes[set * numWays + way];
+    uint64_t candidates = validWays(set) & ~(ULL(1) << way);
+    while (used + need > setCapacity) {
+        assert(candidates);
+        unsigned victim_way = replacementPolicy->victim(set, candidates);
+        BlkType *victim = blkAt(set, victim_way, 0);
+        // a stale tag holds no data and is simply skipped
+        if (victim->isValid()) {
+            DPRINTF(CacheRepl, "set %x: evicting blk %x to make room "
+                    "for %x\n", set, regenerateBlkAddr(victim->tag, set),
+                    addr);
+            victims.push_back(victim);
+            used -= compressedSizes[set * numWays + victim_way];
+        }
+        candidates &= ~(ULL(1) << victim_way);
+    }
+}
+
+void
+PackedTags::insertBlock(Addr addr, MasterID master_id, BlkType *blk)
+{
+    if (!blk->isTouched) {
+        tagsInUse++;
+        blk->isTouched = true;
+        if (!warmedUp && tagsInUse.value() >= warmupBound) {
+            warmedUp = true;
+            warmupCycle = curTick();
+        }
+    }
+
+    unsigned set = extractSet(addr);
+    assert(set == blk->set);
+    unsigned way = wayOf(blk);
+
+    // If we're replacing a block that was previously valid update
+    // stats for it. This can't be done in findBlock() because a
+    // found block might not actually be replaced there if the
+    // coherence protocol says it can't be.
+    if (blk->isValid()) {
+        replacements[0]++;
+        totalRefs += blk->refCount;
+        ++sampledRefs;
+        blk->refCount = 0;
+
+        // deal with evicted block
+        assert(blk->srcMasterId < cache->system->maxMasters());
+        occupancies[blk->srcMasterId]--;
+
+        blk->invalidate();
+
+        if (compression)
+            setBytes[set] -= compressedSizes[set * numWays + way];
+    }
+
+    // the block counts as uncompressed until dataWritten() is called
+    if (compression) {
+        compressedSizes[set * numWays + way] = blkSize;
+        setBytes[set] += blkSize;
+    }
+
+    blk->isTouched = true;
+    // Set tag for new block.  Caller is responsible for setting status.
+    blk->tag = extractTag(addr);
+
+    // deal with what we are bringing in
+    assert(master_id < cache->system->maxMasters());
+    occupancies[master_id]++;
+    blk->srcMasterId = master_id;
+
+    // filling another block of a sector counts as a use of the sector
+    Addr &sector_tag = tags[set * setStride + way];
+    if (sector_tag == blk->tag >> sectorBits) {
+        replacementPolicy->touch(set, way);
+    } else {
+        sector_tag = blk->tag >> sectorBits;
+        replacementPolicy->insert(set, way);
+    }
+}
+
+void
+PackedTags::dataWritten(BlkType *blk)
+{
+    if (!compression)
+        return;
+
+    unsigned size = BDI::compressedSize(blk->data, blkSize);
+    dataSizes.sample(size);
+
+    uint16_t &blk_size = compressedSizes[blk->set * numWays + wayOf(blk)];
+    setBytes[blk->set] += roundUp(size, segmentSize) - blk_size;
+    blk_size = roundUp(size, segmentSize);
+}
+
+void
+PackedTags::invalidate(BlkType *blk)
+{
+    assert(blk);
+    assert(blk->isValid());
+    tagsInUse--;
+    assert(blk->srcMasterId < cache->system->maxMasters());
+    occupancies[blk->srcMasterId]--;
+    blk->srcMasterId = Request::invldMasterId;
+
+    unsigned set = blk->set;
+    unsigned way = wayOf(blk);
+    if (compression) {
+        setBytes[set] -= compressedSizes[set * numWays + way];
+        compressedSizes[set * numWays + way] = 0;
+    }
+
+    // the way is free once the last block of its sector is gone
+    for (unsigned i = 0; i < sectors; ++i) {
+        BlkType *other = blkAt(set, way, i);
+        if (other != blk && other->isValid())
+            return;
+    }
+
+    // should be evicted before valid blocks
+    tags[set * setStride + way] = invalidTag;
+    replacementPolicy->invalidate(set, way);
+}
+
+void
+PackedTags::clearLocks()
+{
+    for (int i = 0; i < numBlocks; i++){
+        blks[i].clearLoadLocks();
+    }
+}
+
+PackedTags *
+PackedTagsParams::create()
+{
+    return new PackedTags(this);
+}
+
+std::string
+PackedTags::print() const {
+    std::string cache_state;
+    for (unsigned i = 0; i < numSets; ++i) {
+        for (unsigned j = 0; j < numWays * sectors; ++j) {
+            const BlkType *blk = &blks[i * numWays * sectors + j];
+            if (blk->isValid())
+                cache_state += csprintf("\tset: %d block: %d %s\n", i, j,
+                                        blk->print());
+        }
+    }
+    if (cache_state.empty())
+        cache_state = "no valid tags\n";
+    return cache_state;
+}
+
+void
+PackedTags::cleanupRefs()
+{
+    for (unsigned i = 0; i < numBlocks; ++i) {
+        if (blks[i].isValid()) {
+            totalRefs += blks[i].refCount;
+            ++sampledRefs;
+        }
+    }
+}
@@ -0,0 +1,389 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Declaration of a set associative tag store with the tags of a set
+ * packed together.
+ */
+
+#ifndef __MEM_CACHE_TAGS_PACKED_TAGS_HH__
+#define __MEM_CACHE_TAGS_PACKED_TAGS_HH__
+
+#include <list>
+#include <vector>
+
+#include "base/bitfield.hh"
+#include "base/statistics.hh"
+#include "mem/cache/replacement/base.hh"
+#include "mem/cache/tags/base.hh"
+#include "mem/cache/blk.hh"
+#include "mem/packet.hh"
+#include "params/PackedTags.hh"
+
+/**
+ * A set associative tag store that keeps its lookup state as a
+ * structure of arrays. The tags of each set are stored next to each
+ * other and compared against the address in one pass, several ways at
+ * a time with SIMD instructions where the host has them, so a lookup
+ * touches a cache block only when its tag matches.
+ *
+ * Replacement is left to a BaseReplacementPolicy, which keeps its own
+ * packed per-way state. The tag store fills invalid ways first and
+ * only asks the policy for a victim when the set is full. With the
+ * LRU policy it replaces blocks in the same order as the LRU tag
+ * store. Up to 64 ways are supported.
+ *
+ * A way may hold a sector of several consecutive blocks under one
+ * tag, each block with its own state. A miss on a block whose sector
+ * is present fills the block into the sector's way; otherwise the
+ * whole sector of the victim way is evicted.
+ *
+ * With compression, every set has twice as many ways as its data
+ * store has room for uncompressed blocks, and blocks take the space
+ * of their BDI compressed size. Blocks are evicted until the new data
+ * fits, so the number of blocks a set holds depends on the data
+ * values. The data itself is kept uncompressed.
+ * @sa  \ref gem5MemorySystem "gem5 Memory System"
+ */
+class PackedTags : public BaseTags
+{
+  public:
+    /** Typedef the block type used in this tag store. */
+    typedef CacheBlk BlkType;
+    /** Typedef for a list of pointers to the local block class. */
+    typedef std::list<BlkType*> BlkList;
+
+    /** Convenience typedef. */
+    typedef PackedTagsParams Params;
+
+    /** The largest supported associativity. */
+    static const unsigned MaxAssoc = 64;
+
+  protected:
+    /** The associativity of the data store. */
+    const unsigned assoc;
+    /** The number of blocks in a sector. */
+    const unsigned sectors;
+    /** Whether the data of blocks is compressed. */
+    const bool compression;
+    /** The number of ways of a set, twice assoc with compression. */
+    const unsigned numWays;
+    /** The number of sets in the cache. */
+    const unsigned numSets;
+    /** Tag slots per set, numWays rounded up to a whole SIMD vector. */
+    const unsigned setStride;
+
+    /** The cache blocks, set by set and way by way. */
+    BlkType *blks;
+    /** The data blocks, 1 per cache block. */
+    uint8_t *dataBlks;
+
+    /**
+     * The sector tag of every way, setStride per set. Ways that do
+     * not hold a valid block, including the padding, have invalidTag.
+     */
+    Addr *tags;
+    /** The replacement policy. */
+    BaseReplacementPolicy *replacementPolicy;
+
+    /** The compressed size of the block in every way, 0 if invalid. */
+    std::vector<uint16_t> compressedSizes;
+    /** The compressed bytes held by every set. */
+    std::vector<unsigned> setBytes;
+    /** The compressed bytes a set has room for. */
+    const unsigned setCapacity;
+
+    /** A tag that no address can have. */
+    static const Addr invalidTag = MaxAddr;
+    /** Compressed blocks take a whole number of segments of this size. */
+    static const unsigned segmentSize = 8;
+
+    /** The amount to shift the address to get the block in a sector. */
+    int blkShift;
+    /** The amount to shift the address to get the set. */
+    int setShift;
+    /** The amount to shift the address to get the sector tag. */
+    int tagShift;
+    /** The log2 of the number of blocks in a sector. */
+    int sectorBits;
+    /** Mask out all bits that aren't part of the set index. */
+    unsigned setMask;
+    /** Mask out all bits that aren't part of the block offset. */
+    unsigned blkMask;
+
+    /** Compressed data sizes. */
+    Stats::Distribution dataSizes;
+
+    /**
+     * Find the way of a set holding a valid block with the given tag.
+     * @param tag The block tag, as returned by extractTag().
+     * @return The way, or -1 if the block is not in the set.
+     */
+    int findWay(unsigned set, Addr tag) const;
+
+    /** The block of a sector in a way. */
+    BlkType *
+    blkAt(unsigned set, unsigned way, unsigned sector) const
+    {
+        return &blks[(set * numWays + way) * sectors + sector];
+    }
+
+    /** The way of a block of this tag store. */
+    unsigned
+    wayOf(const BlkType *blk) const
+    {
+        return (blk - blks) / sectors - blk->set * numWays;
+    }
+
+    /** The position of a block in its sector. */
+    unsigned
+    sectorOf(Addr tag) const
+    {
+        return tag & mask(sectorBits);
+    }
+
+    /** The ways of a set holding at least one valid block. */
+    uint64_t
+    validWays(unsigned set) const
+    {
+        return ~matchingWays(set, invalidTag) & mask(numWays);
+    }
+
+    /** The ways of a set with the given sector tag, padding included. */
+    uint64_t matchingWays(unsigned set, Addr sector_tag) const;
+
+  public:
+    /**
+     * Construct and initialize this tag store.
+     */
+    PackedTags(const Params *p);
+
+    /**
+     * Destructor
+     */
+    virtual ~PackedTags();
+
+    /**
+     * Return the block size.
+     * @return the block size.
+     */
+    unsigned
+    getBlockSize() const
+    {
+        return blkSize;
+    }
+
+    /**
+     * Return the subblock size, always the block size.
+     * @return The block size.
+     */
+    unsigned
+    getSubBlockSize() const
+    {
+        return blkSize;
+    }
+
+    /**
+     * Invalidate the given block.
+     * @param blk The block to invalidate.
+     */
+    void invalidate(BlkType *blk);
+
+    /**
+     * Access block and update replacement data. May not succeed, in
+     * which case NULL pointer is returned. This has all the
+     * implications of a cache access and should only be used as
+     * such. Returns the access latency as a side effect.
+     * @param addr The address to find.
+     * @param lat The access latency.
+     * @return Pointer to the cache block if found.
+     */
+    BlkType* accessBlock(Addr addr, Cycles &lat, int context_src);
+
+    /**
+     * Finds the given address in the cache, do not update replacement
+     * data. i.e. This is a no-side-effect find of a block.
+     * @param addr The address to find.
+     * @return Pointer to the cache block if found.
+     */
+    BlkType* findBlock(Addr addr) const;
+
+    /**
+     * Find a block to evict for the address provided.
+     * @param addr The addr to a find a replacement candidate for.
+     * @param writebacks List for any writebacks to be performed.
+     * @return The candidate block.
+     */
+    BlkType* findVictim(Addr addr, PacketList &writebacks);
+
+    /**
+     * Find the blocks that have to be evicted as well before a block
+     * can hold new data: the rest of the sector of a victim way, or
+     * the blocks making room for the compressed data.
+     * @param blk The victim, or the block being written.
+     * @param addr The address of the new data.
+     * @param data The new data, NULL if not known.
+     * @param victims List to append the blocks to.
+     */
+    void findExtraVictims(BlkType *blk, Addr addr, const uint8_t *data,
+                          BlkList &victims);
+
+    /**
+     * Insert the new block into the cache and tell the replacement
+     * policy about the fill.
+     * @param pkt Packet holding the address to update
+     * @param blk The block to update.
+     */
+    void insertBlock(PacketPtr pkt, BlkType *blk)
+    {
+        insertBlock(pkt->getAddr(), pkt->req->masterId(), blk);
+    }
+
+    /**
+     * Insert the new block into the cache without a packet, as done
+     * when warming the cache.
+     * @param addr The address of the block.
+     * @param master_id The requestor bringing in the block.
+     * @param blk The block to update.
+     */
+    void insertBlock(Addr addr, MasterID master_id, BlkType *blk);
+
+    /**
+     * Update the compressed size of a block after its data was
+     * written.
+     * @param blk The block.
+     */
+    void dataWritten(BlkType *blk);
+
+    /**
+     * Generate the tag from the given address. It is the sector tag
+     * followed by the position of the block in its sector.
+     * @param addr The address to get the tag from.
+     * @return The tag of the address.
+     */
+    Addr extractTag(Addr addr) const
+    {
+        return ((addr >> tagShift) << sectorBits) |
+            ((addr >> blkShift) & mask(sectorBits));
+    }
+
+    /**
+     * Calculate the set index from the address.
+     * @param addr The address to get the set from.
+     * @return The set index of the address.
+     */
+    int extractSet(Addr addr) const
+    {
+        return ((addr >> setShift) & setMask);
+    }
+
+    /**
+     * Get the block offset from an address.
+     * @param addr The address to get the offset of.
+     * @return The block offset.
+     */
+    int extractBlkOffset(Addr addr) const
+    {
+        return (addr & blkMask);
+    }
+
+    /**
+     * Align an address to the block size.
+     * @param addr the address to align.
+     * @return The block address.
+     */
+    Addr blkAlign(Addr addr) const
+    {
+        return (addr & ~(Addr)blkMask);
+    }
+
+    /**
+     * Regenerate the block address from the tag.
+     * @param tag The tag of the block.
+     * @param set The set of the block.
+     * @return The block address.
+     */
+    Addr regenerateBlkAddr(Addr tag, unsigned set) const
+    {
+        return (((tag >> sectorBits) << tagShift) |
+                ((Addr)set << setShift) | (sectorOf(tag) << blkShift));
+    }
+
+    /**
+     * Return the hit latency.
+     * @return the hit latency.
+     */
+    Cycles getHitLatency() const
+    {
+        return hitLatency;
+    }
+
+    /**
+     * Register the compression statistics.
+     */
+    void regStats();
+
+    /**
+     * Iterate through all blocks and clear all locks.
+     * Needed to clear all lock tracking at once.
+     */
+    virtual void clearLocks();
+
+    /**
+     * Called at end of simulation to complete average block reference stats.
+     */
+    virtual void cleanupRefs();
+
+    /**
+     * Print all tags used
+     */
+    virtual std::string print() const;
+
+    /**
+     * Visit each block in the tag store and apply a visitor to the
+     * block.
+     *
+     * The visitor should be a function (or object that behaves like a
+     * function) that takes a cache block reference as its parameter
+     * and returns a bool. A visitor can request the traversal to be
+     * stopped by returning false, returning true causes it to be
+     * called for the next block in the tag store.
+     *
+     * \param visitor Visitor to call on each block.
+     */
+    template <typename V>
+    void forEachBlk(V &visitor) {
+        for (unsigned i = 0; i < numBlocks; ++i) {
+            if (!visitor(blks[i]))
+                return;
+        }
+    }
+};
+
+#endif // __MEM_CACHE_TAGS_PACKED_TAGS_HH__
@@ -58,6 +58,11 @@
 
 using namespace std;
 
+Pool Packet::pool("Packet", sizeof(Packet));
+Pool Packet::dataPool("PacketData", 64);
+// Request has no source file of its own
+Pool Request::pool("Request", sizeof(Request));
+
 // The one downside to bitsets is that static initializers can get ugly.
 #define SET1(a1)                     (1 << (a1))
 #define SET2(a1, a2)                 (SET1(a1) | SET1(a2))
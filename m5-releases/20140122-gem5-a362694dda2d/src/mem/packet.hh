@@ -60,6 +60,7 @@
 #include "base/compiler.hh"
 #include "base/flags.hh"
 #include "base/misc.hh"
+#include "base/pool.hh"
 #include "base/printable.hh"
 #include "base/types.hh"
 #include "mem/request.hh"
@@ -233,7 +234,7 @@ class Packet : public Printable
 
   private:
     static const FlagsType PUBLIC_FLAGS           = 0x00000000;
-    static const FlagsType PRIVATE_FLAGS          = 0x00007F0F;
+    static const FlagsType PRIVATE_FLAGS          = 0x00017F0F;
     static const FlagsType COPY_FLAGS             = 0x0000000F;
 
     static const FlagsType SHARED                 = 0x00000001;
@@ -260,12 +261,49 @@ class Packet : public Printable
     /// suppress the error if this packet encounters a functional
     /// access failure.
     static const FlagsType SUPPRESS_FUNC_ERROR    = 0x00008000;
+    /// the data pointer points to a buffer from the packet data pool
+    /// (only set along with DYNAMIC_DATA)
+    static const FlagsType POOL_DATA              = 0x00010000;
 
     Flags flags;
 
+    /** Pool of packets, all packets are allocated from it. */
+    static Pool pool;
+
+    /**
+     * Pool of data buffers for the packets that allocate their own
+     * data, used when the data fits in a buffer.
+     */
+    static Pool dataPool;
+
   public:
     typedef MemCmd::Command Command;
 
+    /**
+     * Packets are created and destroyed at a very high rate, so they
+     * are taken from a pool rather than the heap. Objects of other
+     * sizes, such as a class derived from Packet, fall back to the
+     * heap.
+     * @{
+     */
+    static void *
+    operator new(size_t size)
+    {
+        if (size != sizeof(Packet))
+            return ::operator new(size);
+        return pool.allocate();
+    }
+
+    static void
+    operator delete(void *p, size_t size)
+    {
+        if (size != sizeof(Packet))
+            ::operator delete(p);
+        else if (p)
+            pool.deallocate(p);
+    }
+    /** @} */
+
     /// The command field of the packet.
     MemCmd cmd;
 
@@ -857,12 +895,14 @@ class Packet : public Printable
     void
     deleteData()
     {
-        if (flags.isSet(ARRAY_DATA))
+        if (flags.isSet(POOL_DATA))
+            dataPool.deallocate(data);
+        else if (flags.isSet(ARRAY_DATA))
             delete [] data;
         else if (flags.isSet(DYNAMIC_DATA))
             delete data;
 
-        flags.clear(STATIC_DATA|DYNAMIC_DATA|ARRAY_DATA);
+        flags.clear(STATIC_DATA|DYNAMIC_DATA|ARRAY_DATA|POOL_DATA);
         data = NULL;
     }
 
@@ -876,8 +916,13 @@ class Packet : public Printable
         }
 
         assert(flags.noneSet(STATIC_DATA|DYNAMIC_DATA));
-        flags.set(DYNAMIC_DATA|ARRAY_DATA);
-        data = new uint8_t[getSize()];
+        if (getSize() <= dataPool.size()) {
+            flags.set(DYNAMIC_DATA|POOL_DATA);
+            data = static_cast<uint8_t *>(dataPool.allocate());
+        } else {
+            flags.set(DYNAMIC_DATA|ARRAY_DATA);
+            data = new uint8_t[getSize()];
+        }
     }
 
     /**
@@ -80,6 +80,7 @@ PageTable::map(Addr vaddr, Addr paddr, int64_t size, bool clobber)
 
         pTable[vaddr] = TheISA::TlbEntry(pid, vaddr, paddr);
         eraseCacheEntry(vaddr);
+        notifyObservers(vaddr);
         updateCache(vaddr, pTable[vaddr]);
     }
 }
@@ -99,6 +100,8 @@ PageTable::remap(Addr vaddr, int64_t size, Addr new_vaddr)
         pTable[new_vaddr] = pTable[vaddr];
         pTable.erase(vaddr);
         eraseCacheEntry(vaddr);
+        notifyObservers(vaddr);
+        notifyObservers(new_vaddr);
         pTable[new_vaddr].updateVaddr(new_vaddr);
         updateCache(new_vaddr, pTable[new_vaddr]);
     }
@@ -115,6 +118,7 @@ PageTable::unmap(Addr vaddr, int64_t size)
         assert(pTable.find(vaddr) != pTable.end());
         pTable.erase(vaddr);
         eraseCacheEntry(vaddr);
+        notifyObservers(vaddr);
     }
 
 }
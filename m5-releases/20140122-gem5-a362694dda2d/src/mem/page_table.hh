@@ -36,7 +36,9 @@
 #ifndef __MEM_PAGE_TABLE_HH__
 #define __MEM_PAGE_TABLE_HH__
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "arch/isa_traits.hh"
 #include "arch/tlb.hh"
@@ -46,6 +48,23 @@
 #include "mem/request.hh"
 #include "sim/serialize.hh"
 
+/**
+ * Interface for translation caches kept outside of the page table (for
+ * example HAsim's VtoP cache) that must be told when a translation
+ * changes.
+ */
+class PageTableObserver
+{
+  public:
+    virtual ~PageTableObserver() {}
+
+    /**
+     * The translation of the page at vaddr was added, changed or removed.
+     * @param vaddr The page-aligned virtual address.
+     */
+    virtual void invalidatePage(Addr vaddr) = 0;
+};
+
 /**
  * Page Table Declaration.
  */
@@ -70,6 +89,15 @@ class PageTable
     const uint64_t pid;
     const std::string _name;
 
+    std::vector<PageTableObserver *> observers;
+
+    void notifyObservers(Addr vaddr)
+    {
+        std::vector<PageTableObserver *>::iterator o = observers.begin();
+        for (; o != observers.end(); ++o)
+            (*o)->invalidatePage(vaddr);
+    }
+
   public:
 
     PageTable(const std::string &__name, uint64_t _pid,
@@ -83,6 +111,17 @@ class PageTable
     Addr pageAlign(Addr a)  { return (a & ~offsetMask); }
     Addr pageOffset(Addr a) { return (a &  offsetMask); }
 
+    /** Register an observer to be notified of translation changes. */
+    void addObserver(PageTableObserver *o) { observers.push_back(o); }
+
+    /** Stop notifying an observer, before it is destroyed. */
+    void
+    removeObserver(PageTableObserver *o)
+    {
+        observers.erase(std::remove(observers.begin(), observers.end(), o),
+                        observers.end());
+    }
+
     void map(Addr vaddr, Addr paddr, int64_t size, bool clobber = false);
     void remap(Addr vaddr, int64_t size, Addr new_vaddr);
     void unmap(Addr vaddr, int64_t size);
@@ -47,9 +47,13 @@
 #include <cerrno>
 #include <climits>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
 
+#include "base/hashmap.hh"
+#include "base/intmath.hh"
 #include "base/trace.hh"
 #include "debug/BusAddrRanges.hh"
 #include "debug/Checkpoint.hh"
@@ -58,9 +62,275 @@
 
 using namespace std;
 
+namespace {
+
+/**
+ * A paged memory image starts with a page-sized header, followed by
+ * one entry per page of the backing store, and the data of the stored
+ * pages. The data section is page aligned and uncompressed, so that it
+ * can be mapped directly.
+ */
+const char pagedMagic[8] = { 'M', '5', 'P', 'A', 'G', 'E', 'D', '\0' };
+const uint32_t pagedVersion = 1;
+const uint64_t pagedPageSize = 4096;
+
+struct PagedHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t pageSize;
+    uint64_t numPages;
+    uint64_t numData;
+    uint64_t dataOffset;
+    // absolute path of the image this one is incremental to
+    char base[pagedPageSize - 40];
+};
+
+/** The page is all zero. */
+const uint64_t PageZero = 0;
+/** The page is stored in the data section at the given index. */
+const uint64_t PageData = 1;
+/** The page is the same as the page at the same place in the base. */
+const uint64_t PageBase = 2;
+
+struct PageEntry
+{
+    uint64_t hash;
+    uint64_t kind;
+    uint64_t index;
+};
+
+/**
+ * Hash a page, noting whether it is all zero on the way.
+ */
+uint64_t
+hashPage(const uint8_t* page, bool& zero)
+{
+    const uint64_t* w = reinterpret_cast<const uint64_t*>(page);
+    uint64_t h = ULL(14695981039346656037);
+    uint64_t any = 0;
+    for (uint64_t i = 0; i < pagedPageSize / sizeof(uint64_t); ++i) {
+        any |= w[i];
+        h = (h ^ w[i]) * ULL(1099511628211);
+    }
+    zero = any == 0;
+    return h;
+}
+
+void
+writeAll(int fd, const void* buf, uint64_t len, const string& filename)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(buf);
+    while (len > 0) {
+        ssize_t n = write(fd, p, len < (uint64_t)INT_MAX ? len : INT_MAX);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            fatal("Write failed on physical memory checkpoint file '%s'\n",
+                  filename);
+        p += n;
+        len -= n;
+    }
+}
+
+void
+readAll(int fd, void* buf, uint64_t len, off_t offset,
+        const string& filename)
+{
+    uint8_t* p = static_cast<uint8_t*>(buf);
+    while (len > 0) {
+        ssize_t n = pread(fd, p, len < (uint64_t)INT_MAX ? len : INT_MAX,
+                          offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            fatal("Read failed on physical memory checkpoint file '%s'\n",
+                  filename);
+        p += n;
+        offset += n;
+        len -= n;
+    }
+}
+
+/**
+ * A paged image opened for reading, together with the chain of
+ * images it is incremental to.
+ */
+class PagedImage
+{
+  private:
+
+    std::string filename;
+    int fd;
+    PagedHeader header;
+    std::vector<PageEntry> table;
+    PagedImage* baseImage;
+
+  public:
+
+    PagedImage(const std::string& _filename)
+        : filename(_filename), baseImage(NULL)
+    {
+        fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            perror("open");
+            fatal("Can't open physical memory checkpoint file '%s'\n",
+                  filename);
+        }
+
+        readAll(fd, &header, sizeof(header), 0, filename);
+        if (memcmp(header.magic, pagedMagic, sizeof(pagedMagic)) != 0 ||
+            header.version != pagedVersion ||
+            header.pageSize != pagedPageSize)
+            fatal("'%s' is not a paged memory checkpoint\n", filename);
+
+        table.resize(header.numPages);
+        readAll(fd, &table[0], table.size() * sizeof(PageEntry),
+                sizeof(header), filename);
+    }
+
+    ~PagedImage()
+    {
+        delete baseImage;
+        close(fd);
+    }
+
+    uint64_t numPages() const { return header.numPages; }
+
+    const PageEntry& entry(uint64_t page) const { return table[page]; }
+
+    PagedImage* base()
+    {
+        if (baseImage == NULL) {
+            if (header.base[0] == '\0')
+                panic("Paged image '%s' has no base\n", filename);
+            baseImage = new PagedImage(header.base);
+            if (baseImage->numPages() != numPages())
+                fatal("Base image '%s' of '%s' has %d pages, expected %d\n",
+                      header.base, filename, baseImage->numPages(),
+                      numPages());
+        }
+        return baseImage;
+    }
+
+    /**
+     * Read the contents of a single page, following the chain of
+     * base images if needed.
+     */
+    void readPage(uint64_t page, uint8_t* buf)
+    {
+        const PageEntry& e = table[page];
+        if (e.kind == PageZero)
+            memset(buf, 0, pagedPageSize);
+        else if (e.kind == PageData)
+            readAll(fd, buf, pagedPageSize,
+                    header.dataOffset + e.index * pagedPageSize, filename);
+        else
+            base()->readPage(page, buf);
+    }
+
+    /**
+     * Restore the image into a backing store. The data section is
+     * mapped and the non-zero pages are copied out of it, leaving
+     * zero pages untouched if the store is known to be clean.
+     */
+    void restore(uint8_t* pmem, bool clean)
+    {
+        for (uint64_t p = 0; p < numPages(); ++p) {
+            if (table[p].kind == PageBase) {
+                base()->restore(pmem, clean);
+                clean = false;
+                break;
+            }
+        }
+
+        if (header.numData == 0 && clean)
+            return;
+
+        uint8_t* data = NULL;
+        uint64_t data_size = header.numData * pagedPageSize;
+        if (data_size) {
+            data = (uint8_t*) mmap(NULL, data_size, PROT_READ, MAP_SHARED,
+                                   fd, header.dataOffset);
+            if (data == (uint8_t*) MAP_FAILED) {
+                perror("mmap");
+                fatal("Could not mmap physical memory checkpoint file "
+                      "'%s'\n", filename);
+            }
+            madvise(data, data_size, MADV_SEQUENTIAL);
+        }
+
+        for (uint64_t p = 0; p < numPages(); ++p) {
+            const PageEntry& e = table[p];
+            if (e.kind == PageData)
+                memcpy(pmem + p * pagedPageSize,
+                       data + e.index * pagedPageSize, pagedPageSize);
+            else if (e.kind == PageZero && !clean)
+                memset(pmem + p * pagedPageSize, 0, pagedPageSize);
+        }
+
+        if (data)
+            munmap(data, data_size);
+    }
+
+    /**
+     * Map the image copy-on-write into a backing store, so that pages
+     * are only read from the file when the simulated system touches
+     * them. Adjacent stored pages are mapped together, and zero pages
+     * are left anonymous.
+     */
+    void map(uint8_t* pmem, bool clean)
+    {
+        for (uint64_t p = 0; p < numPages(); ++p) {
+            if (table[p].kind == PageBase) {
+                base()->map(pmem, clean);
+                clean = false;
+                break;
+            }
+        }
+
+        for (uint64_t p = 0; p < numPages(); ) {
+            const PageEntry& e = table[p];
+            uint64_t q = p + 1;
+            if (e.kind == PageData) {
+                while (q < numPages() && table[q].kind == PageData &&
+                       table[q].index == e.index + (q - p))
+                    ++q;
+                mapRun(pmem + p * pagedPageSize, (q - p) * pagedPageSize,
+                       fd, header.dataOffset + e.index * pagedPageSize);
+            } else if (e.kind == PageZero) {
+                while (q < numPages() && table[q].kind == PageZero)
+                    ++q;
+                if (!clean)
+                    mapRun(pmem + p * pagedPageSize,
+                           (q - p) * pagedPageSize, -1, 0);
+            }
+            p = q;
+        }
+    }
+
+  private:
+
+    void mapRun(uint8_t* addr, uint64_t len, int fd, off_t offset)
+    {
+        int flags = MAP_PRIVATE | MAP_FIXED | (fd < 0 ? MAP_ANON : 0);
+        if (mmap(addr, len, PROT_READ | PROT_WRITE, flags, fd,
+                 offset) == MAP_FAILED) {
+            perror("mmap");
+            fatal("Could not map physical memory checkpoint file '%s', "
+                  "consider raising vm.max_map_count\n", filename);
+        }
+    }
+};
+
+} // anonymous namespace
+
 PhysicalMemory::PhysicalMemory(const string& _name,
-                               const vector<AbstractMemory*>& _memories) :
-    _name(_name), size(0)
+                               const vector<AbstractMemory*>& _memories,
+                               Enums::MemCheckpointFormat cpt_format,
+                               const string& cpt_base, bool cpt_lazy) :
+    _name(_name), size(0), cptFormat(cpt_format), cptBase(cpt_base),
+    cptLazy(cpt_lazy)
 {
     // add the memories from the system to the address map as
     // appropriate
@@ -300,16 +570,42 @@ PhysicalMemory::serializeStore(ostream& os, unsigned int store_id,
     string filename = name() + ".store" + to_string(store_id) + ".pmem";
     long range_size = range.size();
 
+    string format = Enums::MemCheckpointFormatStrings[cptFormat];
+
     DPRINTF(Checkpoint, "Serializing physical memory %s with size %d\n",
             filename, range_size);
 
     SERIALIZE_SCALAR(store_id);
     SERIALIZE_SCALAR(filename);
     SERIALIZE_SCALAR(range_size);
+    SERIALIZE_SCALAR(format);
 
     // write memory file
     string filepath = Checkpoint::dir() + "/" + filename.c_str();
-    int fd = creat(filepath.c_str(), 0664);
+    if (cptFormat == Enums::paged) {
+        string base;
+        if (!cptBase.empty()) {
+            // remember the base by its absolute path, so that the
+            // image can be read independent of the working directory
+            string base_file = cptBase + "/" + filename;
+            char* resolved = realpath(base_file.c_str(), NULL);
+            if (resolved == NULL)
+                fatal("Can't find base memory checkpoint file '%s'\n",
+                      base_file);
+            base = resolved;
+            free(resolved);
+        }
+        writePagedStore(filepath, range, pmem, base);
+    } else {
+        writeGzipStore(filepath, range, pmem);
+    }
+}
+
+void
+PhysicalMemory::writeGzipStore(const string& filename, AddrRange range,
+                               uint8_t* pmem)
+{
+    int fd = creat(filename.c_str(), 0664);
     if (fd < 0) {
         perror("creat");
         fatal("Can't open physical memory checkpoint file '%s'\n",
@@ -344,6 +640,123 @@ PhysicalMemory::serializeStore(ostream& os, unsigned int store_id,
 
 }
 
+void
+PhysicalMemory::writePagedStore(const string& filename, AddrRange range,
+                                uint8_t* pmem, const string& base)
+{
+    if (range.size() % pagedPageSize != 0)
+        fatal("Paged memory checkpoints need a store size that is a "
+              "multiple of %d bytes, %s is %d bytes\n", pagedPageSize,
+              range.to_string(), range.size());
+
+    uint64_t num_pages = range.size() / pagedPageSize;
+
+    PagedImage* base_image = NULL;
+    if (!base.empty()) {
+        base_image = new PagedImage(base);
+        if (base_image->numPages() != num_pages)
+            fatal("Base memory checkpoint '%s' has %d pages, expected %d\n",
+                  base, base_image->numPages(), num_pages);
+    }
+
+    // classify every page, the first occurrence of each distinct
+    // page is stored and later copies refer to it
+    vector<PageEntry> table(num_pages);
+    vector<uint64_t> stored;
+    m5::hash_map<uint64_t, uint64_t> first;
+    vector<uint8_t> base_page(base_image ? pagedPageSize : 0);
+    uint64_t num_zero = 0, num_dup = 0, num_base = 0;
+
+    for (uint64_t p = 0; p < num_pages; ++p) {
+        const uint8_t* page = pmem + p * pagedPageSize;
+        PageEntry& e = table[p];
+        bool zero;
+        e.hash = hashPage(page, zero);
+        e.index = 0;
+
+        if (zero) {
+            e.kind = PageZero;
+            ++num_zero;
+            continue;
+        }
+
+        if (base_image) {
+            const PageEntry& b = base_image->entry(p);
+            if (b.kind != PageZero && b.hash == e.hash) {
+                base_image->readPage(p, &base_page[0]);
+                if (memcmp(&base_page[0], page, pagedPageSize) == 0) {
+                    e.kind = PageBase;
+                    ++num_base;
+                    continue;
+                }
+            }
+        }
+
+        e.kind = PageData;
+        m5::hash_map<uint64_t, uint64_t>::iterator f = first.find(e.hash);
+        if (f != first.end() &&
+            memcmp(pmem + f->second * pagedPageSize, page,
+                   pagedPageSize) == 0) {
+            e.index = table[f->second].index;
+            ++num_dup;
+        } else {
+            e.index = stored.size();
+            stored.push_back(p);
+            if (f == first.end())
+                first[e.hash] = p;
+        }
+    }
+
+    delete base_image;
+
+    DPRINTF(Checkpoint, "Paged memory image %s: %d zero, %d duplicate, "
+            "%d unchanged and %d stored pages\n", filename, num_zero,
+            num_dup, num_base, stored.size());
+
+    PagedHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, pagedMagic, sizeof(pagedMagic));
+    header.version = pagedVersion;
+    header.pageSize = pagedPageSize;
+    header.numPages = num_pages;
+    header.numData = stored.size();
+    header.dataOffset = roundUp(sizeof(header) +
+                                num_pages * sizeof(PageEntry),
+                                pagedPageSize);
+    if (base.size() >= sizeof(header.base))
+        fatal("Base memory checkpoint path '%s' is too long\n", base);
+    strncpy(header.base, base.c_str(), sizeof(header.base));
+
+    int fd = creat(filename.c_str(), 0664);
+    if (fd < 0) {
+        perror("creat");
+        fatal("Can't open physical memory checkpoint file '%s'\n",
+              filename);
+    }
+
+    writeAll(fd, &header, sizeof(header), filename);
+    writeAll(fd, &table[0], num_pages * sizeof(PageEntry), filename);
+
+    if (lseek(fd, header.dataOffset, SEEK_SET) < 0)
+        fatal("Seek failed on physical memory checkpoint file '%s'\n",
+              filename);
+
+    // stored pages appear in address order, so write each run of
+    // adjacent pages at once
+    for (uint64_t i = 0; i < stored.size(); ) {
+        uint64_t j = i + 1;
+        while (j < stored.size() && stored[j] == stored[j - 1] + 1)
+            ++j;
+        writeAll(fd, pmem + stored[i] * pagedPageSize,
+                 (j - i) * pagedPageSize, filename);
+        i = j;
+    }
+
+    if (close(fd))
+        fatal("Close failed on physical memory checkpoint file '%s'\n",
+              filename);
+}
+
 void
 PhysicalMemory::unserialize(Checkpoint* cp, const string& section)
 {
@@ -372,8 +785,6 @@ PhysicalMemory::unserialize(Checkpoint* cp, const string& section)
 void
 PhysicalMemory::unserializeStore(Checkpoint* cp, const string& section)
 {
-    const uint32_t chunk_size = 16384;
-
     unsigned int store_id;
     UNSERIALIZE_SCALAR(store_id);
 
@@ -381,21 +792,25 @@ PhysicalMemory::unserializeStore(Checkpoint* cp, const string& section)
     UNSERIALIZE_SCALAR(filename);
     string filepath = cp->cptDir + "/" + filename;
 
-    // mmap memoryfile
-    int fd = open(filepath.c_str(), O_RDONLY);
-    if (fd < 0) {
-        perror("open");
-        fatal("Can't open physical memory checkpoint file '%s'", filename);
-    }
-
-    gzFile compressed_mem = gzdopen(fd, "rb");
-    if (compressed_mem == NULL)
-        fatal("Insufficient memory to allocate compression state for %s\n",
-              filename);
+    // checkpoints from before the paged format are all gzip
+    string format = "gzip";
+    UNSERIALIZE_OPT_SCALAR(format);
 
     uint8_t* pmem = backingStore[store_id].second;
     AddrRange range = backingStore[store_id].first;
 
+    if (cptLazy && format == "paged") {
+        if (sysconf(_SC_PAGESIZE) == pagedPageSize) {
+            mapPagedStore(filepath, range, pmem);
+            return;
+        }
+        warn("Host page size is not %d bytes, restoring %s eagerly\n",
+             pagedPageSize, filename);
+    } else if (cptLazy) {
+        warn("Only paged memory checkpoints can be restored lazily, "
+             "restoring %s eagerly\n", filename);
+    }
+
     // unmap file that was mmapped in the constructor, this is
     // done here to make sure that gzip and open don't muck with
     // our nice large space of memory before we reallocate it
@@ -419,6 +834,32 @@ PhysicalMemory::unserializeStore(Checkpoint* cp, const string& section)
         fatal("Could not mmap physical memory!\n");
     }
 
+    if (format == "paged")
+        readPagedStore(filepath, range, pmem);
+    else if (format == "gzip")
+        readGzipStore(filepath, range, pmem);
+    else
+        fatal("Unknown format '%s' of physical memory checkpoint '%s'\n",
+              format, filename);
+}
+
+void
+PhysicalMemory::readGzipStore(const string& filename, AddrRange range,
+                              uint8_t* pmem)
+{
+    const uint32_t chunk_size = 16384;
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        perror("open");
+        fatal("Can't open physical memory checkpoint file '%s'", filename);
+    }
+
+    gzFile compressed_mem = gzdopen(fd, "rb");
+    if (compressed_mem == NULL)
+        fatal("Insufficient memory to allocate compression state for %s\n",
+              filename);
+
     uint64_t curr_size = 0;
     long* temp_page = new long[chunk_size];
     long* pmem_current;
@@ -447,3 +888,86 @@ PhysicalMemory::unserializeStore(Checkpoint* cp, const string& section)
         fatal("Close failed on physical memory checkpoint file '%s'\n",
               filename);
 }
+
+void
+PhysicalMemory::readPagedStore(const string& filename, AddrRange range,
+                               uint8_t* pmem)
+{
+    PagedImage image(filename);
+    if (image.numPages() * pagedPageSize != range.size())
+        fatal("Paged memory checkpoint '%s' has %d pages, expected %d\n",
+              filename, image.numPages(), range.size() / pagedPageSize);
+
+    // the store was just mapped, so zero pages need no work
+    image.restore(pmem, true);
+}
+
+void
+PhysicalMemory::mapPagedStore(const string& filename, AddrRange range,
+                              uint8_t* pmem)
+{
+    PagedImage image(filename);
+    if (image.numPages() * pagedPageSize != range.size())
+        fatal("Paged memory checkpoint '%s' has %d pages, expected %d\n",
+              filename, image.numPages(), range.size() / pagedPageSize);
+
+    // start from a clean store at the same address, as the memories
+    // already point to it
+    if (mmap(pmem, range.size(), PROT_READ | PROT_WRITE,
+             MAP_ANON | MAP_PRIVATE | MAP_FIXED, -1, 0) == MAP_FAILED) {
+        perror("mmap");
+        fatal("Could not mmap physical memory!\n");
+    }
+
+    image.map(pmem, true);
+
+    uint64_t mapped = 0;
+    for (uint64_t p = 0; p < image.numPages(); ++p)
+        if (image.entry(p).kind != PageZero)
+            ++mapped;
+
+    // faults are scattered, so avoid pulling in neighbouring pages
+    madvise(pmem, range.size(), MADV_RANDOM);
+
+    lazyStores.push_back(make_pair(range, pmem));
+
+    inform("Lazily mapped %d of %d pages of %s\n", mapped,
+           image.numPages(), filename);
+}
+
+uint64_t
+PhysicalMemory::lazyTouchedPages() const
+{
+    if (lazyStores.empty())
+        return 0;
+
+    // the page map has one 64-bit entry per virtual page, with bit 63
+    // set if the page is present and bit 62 if it is swapped out
+    int fd = open("/proc/self/pagemap", O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    const uint64_t chunk = 4096;
+    vector<uint64_t> entries(chunk);
+    uint64_t touched = 0;
+    for (vector<pair<AddrRange, uint8_t*> >::const_iterator s =
+             lazyStores.begin(); s != lazyStores.end(); ++s) {
+        uint64_t first = (uint64_t)s->second / pagedPageSize;
+        uint64_t num_pages = s->first.size() / pagedPageSize;
+        for (uint64_t p = 0; p < num_pages; p += chunk) {
+            uint64_t n = min(chunk, num_pages - p);
+            ssize_t len = pread(fd, &entries[0], n * sizeof(uint64_t),
+                                (first + p) * sizeof(uint64_t));
+            if (len != (ssize_t)(n * sizeof(uint64_t))) {
+                close(fd);
+                return touched;
+            }
+            for (uint64_t i = 0; i < n; ++i)
+                if (entries[i] & (ULL(3) << 62))
+                    ++touched;
+        }
+    }
+
+    close(fd);
+    return touched;
+}
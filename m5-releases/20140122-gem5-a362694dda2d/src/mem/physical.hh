@@ -41,6 +41,7 @@
 #define __PHYSICAL_MEMORY_HH__
 
 #include "base/addr_range_map.hh"
+#include "enums/MemCheckpointFormat.hh"
 #include "mem/port.hh"
 
 /**
@@ -88,6 +89,20 @@ class PhysicalMemory : public Serializable
     // system
     std::vector<std::pair<AddrRange, uint8_t*> > backingStore;
 
+    // The format used for new checkpoints of the backing store
+    Enums::MemCheckpointFormat cptFormat;
+
+    // Checkpoint directory that paged checkpoints are incremental
+    // to, empty if they should be self-contained
+    std::string cptBase;
+
+    // Map paged checkpoints copy-on-write on restore rather than
+    // reading them in
+    bool cptLazy;
+
+    // The backing stores that were restored lazily
+    std::vector<std::pair<AddrRange, uint8_t*> > lazyStores;
+
     // Prevent copying
     PhysicalMemory(const PhysicalMemory&);
 
@@ -105,13 +120,63 @@ class PhysicalMemory : public Serializable
     void createBackingStore(AddrRange range,
                             const std::vector<AbstractMemory*>& _memories);
 
+    /**
+     * Write a backing store as a gzip compressed image of the whole
+     * range.
+     */
+    void writeGzipStore(const std::string& filename, AddrRange range,
+                        uint8_t* pmem);
+
+    /**
+     * Write a backing store as a paged image, storing each distinct
+     * non-zero page once, and if a base is given, only the pages
+     * that differ from the base image.
+     *
+     * @param filename File to write the image to
+     * @param range The address range of the backing store
+     * @param pmem The host pointer to the backing store
+     * @param base Paged image this one is incremental to, or empty
+     */
+    void writePagedStore(const std::string& filename, AddrRange range,
+                         uint8_t* pmem, const std::string& base);
+
+    /**
+     * Read a gzip compressed image into a zeroed backing store.
+     */
+    void readGzipStore(const std::string& filename, AddrRange range,
+                       uint8_t* pmem);
+
+    /**
+     * Read a paged image, and any images it is incremental to, into a
+     * zeroed backing store.
+     */
+    void readPagedStore(const std::string& filename, AddrRange range,
+                        uint8_t* pmem);
+
+    /**
+     * Map a paged image, and any images it is incremental to,
+     * copy-on-write over a backing store. Pages are read from the
+     * files as they are touched, and the files must not be changed
+     * while the store is in use.
+     */
+    void mapPagedStore(const std::string& filename, AddrRange range,
+                       uint8_t* pmem);
+
   public:
 
     /**
      * Create a physical memory object, wrapping a number of memories.
+     *
+     * @param cpt_format Format to use when checkpointing the memories
+     * @param cpt_base Checkpoint that paged checkpoints are incremental to
+     * @param cpt_lazy Restore paged checkpoints on demand
      */
     PhysicalMemory(const std::string& _name,
-                   const std::vector<AbstractMemory*>& _memories);
+                   const std::vector<AbstractMemory*>& _memories,
+                   Enums::MemCheckpointFormat cpt_format =
+                   Enums::gzip,
+                   const std::string& cpt_base = "",
+                   bool cpt_lazy = false);
 
     /**
      * Unmap all the backing store we have used.
@@ -150,6 +215,14 @@ class PhysicalMemory : public Serializable
      */
     uint64_t totalSize() const { return size; }
 
+    /**
+     * Get the number of pages of the lazily restored backing stores
+     * that have been touched since the restore, as seen by the host.
+     *
+     * @return The number of touched pages, 0 if nothing was restored lazily
+     */
+    uint64_t lazyTouchedPages() const;
+
      /**
      * Get the pointers to the backing store for external host
      * access. Note that memory in the guest should be accessed using
@@ -165,6 +238,16 @@ class PhysicalMemory : public Serializable
     std::vector<std::pair<AddrRange, uint8_t*> > getBackingStore() const
     { return backingStore; }
 
+    /**
+     * Get the memories that are part of the global address map, for
+     * external users that resolve physical addresses to host
+     * addresses directly (e.g. HAsim).
+     *
+     * @return The address-mapped memories
+     */
+    const std::vector<AbstractMemory*>& getMemories() const
+    { return memories; }
+
     /**
      * Perform an untimed memory access and update all the state
      * (e.g. locked addresses) and statistics accordingly. The packet
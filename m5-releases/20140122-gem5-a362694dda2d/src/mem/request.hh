@@ -56,6 +56,7 @@
 
 #include "base/flags.hh"
 #include "base/misc.hh"
+#include "base/pool.hh"
 #include "base/types.hh"
 #include "sim/core.hh"
 
@@ -238,7 +239,33 @@ class Request
     /** program counter of initiating access; for tracing/debugging */
     Addr _pc;
 
+    /** Pool of requests, all requests are allocated from it. */
+    static Pool pool;
+
   public:
+    /**
+     * Requests are allocated from a pool, as packets are. Objects of
+     * other sizes fall back to the heap.
+     * @{
+     */
+    static void *
+    operator new(size_t size)
+    {
+        if (size != sizeof(Request))
+            return ::operator new(size);
+        return pool.allocate();
+    }
+
+    static void
+    operator delete(void *p, size_t size)
+    {
+        if (size != sizeof(Request))
+            ::operator delete(p);
+        else if (p)
+            pool.deallocate(p);
+    }
+    /** @} */
+
     /** Minimal constructor.  No fields are initialized. 
      *  (Note that _flags and privateFlags are cleared by Flags
      *  default constructor.)
@@ -111,6 +111,11 @@ class Consumer
               m_consumer_ptr->removeScheduledWakeupTime(when());
           }
 
+          const std::string name() const
+          {
+              return m_consumer_ptr->em->name() + ".wakeup_event";
+          }
+
       private:
           Consumer* m_consumer_ptr;
     };
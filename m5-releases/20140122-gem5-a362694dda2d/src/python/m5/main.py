@@ -82,6 +82,9 @@ def parse_options():
     group("Statistics Options")
     option("--stats-file", metavar="FILE", default="stats.txt",
         help="Sets the output file for statistics [Default: %default]")
+    option("--stats-binary", metavar="FILE", default="",
+        help="Also write statistics in binary form to FILE, see "
+        "m5.stats.binary")
 
     # Configuration Options
     group("Configuration Options")
@@ -106,6 +109,17 @@ def parse_options():
         help="Sets the output file for debug [Default: %default]")
     option("--debug-ignore", metavar="EXPR", action='append', split=':',
         help="Ignore EXPR sim objects")
+    option("--debug-binary", action='store_true',
+        help="Record DPRINTF and DDUMP output in binary ring buffers, "
+        "written to --debug-binary-file at exit (see "
+        "util/decode_debug_trace.py). Instruction traces such as the "
+        "Exec flag are still written as text to --debug-file")
+    option("--debug-binary-file", metavar="FILE", default="trace.bin",
+        help="Sets the output file for binary debug buffers "
+        "[Default: %default]")
+    option("--debug-buffer-size", metavar="SIZE", default="64MB",
+        help="Size of the binary debug buffer of each thread "
+        "[Default: %default]")
     option("--remote-gdb-port", type='int', default=7000,
         help="Remote gdb base port (set to 0 to disable listening)")
 
@@ -313,6 +327,8 @@ def main(*args):
 
     # set stats options
     stats.initText(options.stats_file)
+    if options.stats_binary:
+        stats.initBinary(options.stats_binary)
 
     # set debugging options
     debug.setRemoteGDBPort(options.remote_gdb_port)
@@ -347,6 +363,8 @@ def main(*args):
         trace.enable()
 
     trace.output(options.debug_file)
+    if options.debug_binary:
+        trace.binary(options.debug_binary_file, options.debug_buffer_size)
 
     for ignore in options.debug_ignore:
         check_tracing()
@@ -0,0 +1,185 @@
+# Copyright (c) 2014 The Regents of The University of Michigan
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Assign SimObjects to event queues for parallel simulation.
+#
+# The objects that can run on their own queue are the CPUs and the
+# Ruby controllers, each together with its children (e.g. private L1
+# caches hanging off a CPU).  Units whose objects are connected to
+# each other through ports are kept on the same queue, since every
+# request between them would otherwise cross queues.  Everything else
+# (buses, shared caches, memories, the Ruby network) stays on queue 0.
+#
+# The cost of a unit is the number of events its objects processed
+# during a profiling run:
+#
+#     m5.partition.start_profile()
+#     m5.simulate(window)
+#     m5.partition.dump_profile('eventprofile.txt')
+#
+# and a later run reads the profile back:
+#
+#     m5.partition.partition(root, 8, 'm5out/eventprofile.txt')
+#     m5.instantiate()
+#
+# Without a profile every unit costs the same.
+
+import internal.event
+import objects
+
+from m5.util import fatal, inform
+from SimObject import isSimObject, isSimObjectVector
+
+def start_profile():
+    """Count the events processed on each queue by event name."""
+    internal.event.startEventProfile()
+
+def dump_profile(filename):
+    """Stop profiling and write the counts to filename in the output
+    directory."""
+    internal.event.dumpEventProfile(filename)
+
+def read_profile(filename):
+    """Read a profile written by dump_profile() into a dict mapping
+    event names to counts."""
+    counts = {}
+    for line in open(filename):
+        fields = line.split(None, 1)
+        if len(fields) == 2:
+            counts[fields[1].strip()] = int(fields[0])
+    return counts
+
+def _unit_types():
+    types = []
+    for name in ('BaseCPU', 'RubyController'):
+        cls = getattr(objects, name, None)
+        if cls is not None:
+            types.append(cls)
+    return tuple(types)
+
+def _find_units(root, types):
+    """Map each object to the root of the unit it belongs to, or to
+    None if it is shared."""
+    owner = {}
+    def walk(obj, unit):
+        if unit is None and isinstance(obj, types):
+            unit = obj
+        owner[obj] = unit
+        for child in obj._children.itervalues():
+            if isSimObjectVector(child):
+                for c in child:
+                    walk(c, unit)
+            else:
+                walk(child, unit)
+    walk(root, None)
+    return owner
+
+def _peers(obj):
+    for ref in obj._port_refs.itervalues():
+        for el in getattr(ref, 'elements', [ref]):
+            peer = el.peer
+            if peer is not None and isSimObject(getattr(peer, 'simobj',
+                                                        None)):
+                yield peer.simobj
+
+def _object_costs(root, counts):
+    """Attribute each event count to the object with the longest path
+    that prefixes the event name.  Unattributed events, which have no
+    name of their own, are charged to root."""
+    by_path = dict((obj.path(), obj) for obj in root.descendants())
+    cost = dict((obj, 0) for obj in by_path.itervalues())
+    for name, count in counts.iteritems():
+        parts = name.split('.')
+        for n in range(len(parts), 0, -1):
+            obj = by_path.get('.'.join(parts[:n]))
+            if obj is not None:
+                cost[obj] += count
+                break
+        else:
+            cost[root] += count
+    return cost
+
+def partition(root, num_queues, profile=None):
+    """Assign eventq_index to the CPUs and Ruby controllers under root,
+    balancing their cost over num_queues queues.  Returns the expected
+    load of each queue."""
+    if num_queues < 1:
+        fatal("Cannot partition onto %d event queues", num_queues)
+
+    owner = _find_units(root, _unit_types())
+
+    # Union units that talk to each other directly through ports.
+    group = dict((u, u) for u in set(owner.itervalues()) if u is not None)
+    def find(u):
+        while group[u] is not u:
+            group[u] = group[group[u]]
+            u = group[u]
+        return u
+
+    for obj, unit in owner.iteritems():
+        if unit is None:
+            continue
+        for peer in _peers(obj):
+            other = owner.get(peer)
+            if other is not None and find(other) is not find(unit):
+                group[find(other)] = find(unit)
+
+    if profile:
+        cost = _object_costs(root, read_profile(profile))
+    else:
+        cost = dict((obj, int(obj is unit))
+                    for obj, unit in owner.iteritems())
+
+    shared = 0
+    groups = {}
+    for obj, unit in owner.iteritems():
+        if unit is None:
+            shared += cost[obj]
+        else:
+            g = find(unit)
+            units, c = groups.get(g, (set(), 0))
+            units.add(unit)
+            groups[g] = (units, c + cost[obj])
+
+    # Longest processing time first: place the most expensive group on
+    # the least loaded queue.  Queue 0 starts with the shared objects.
+    load = [0] * num_queues
+    load[0] = shared
+    order = sorted(groups.itervalues(),
+                   key=lambda g: (-g[1], min(u.path() for u in g[0])))
+    for units, c in order:
+        q = min(range(num_queues), key=lambda i: (load[i], i))
+        load[q] += c
+        for unit in units:
+            unit.eventq_index = q
+
+    total = sum(load)
+    if total:
+        mean = float(total) / num_queues
+        inform("Partitioned %d groups onto %d event queues, "
+               "expected imbalance %.2f (max/mean load)",
+               len(groups), num_queues, max(load) / mean)
+    return load
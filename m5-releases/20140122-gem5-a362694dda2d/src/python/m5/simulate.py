@@ -209,6 +209,128 @@ def checkpoint(dir):
     internal.core.serializeAll(dir)
     resume(root)
 
+_fork_seq = 0
+def _forkOutdir(simout):
+    from m5 import options
+    return simout % { "parent" : options.outdir, "fork_seq" : _fork_seq }
+
+def fork(simout="%(parent)s.f%(fork_seq)i"):
+    """Fork the simulator, e.g. to run a detailed sample from the
+    current state while this process carries on.
+
+    The system is drained before forking and is resumed by the next
+    simulate() in both processes, so operations that need a drained
+    system, like switchCpus(..., do_drain=False), can follow directly.
+    The child writes its output (stats, stdout and stderr) to the
+    directory named by simout, in which %(parent)s is replaced by the
+    parent's output directory and %(fork_seq)i by the number of forks
+    made so far.
+
+    Returns the pid of the child to the parent and 0 to the child.
+    """
+    global _fork_seq
+    from m5 import options
+
+    if internal.event.cvar.numMainEventQueues > 1:
+        fatal("Cannot fork a simulator with more than one event queue")
+
+    root = objects.Root.getInstance()
+    drain(root)
+    need_resume.append(root)
+
+    # anything buffered now would otherwise be written by both
+    # processes
+    sys.stdout.flush()
+    sys.stderr.flush()
+    internal.core.flushOutputDir()
+
+    outdir = _forkOutdir(simout)
+    _fork_seq += 1
+    pid = os.fork()
+    if pid == 0:
+        internal.core.redirectOutputDir(outdir)
+        options.outdir = outdir
+        for f, name in ((sys.stdout, options.stdout_file),
+                        (sys.stderr, options.stderr_file)):
+            fd = os.open(os.path.join(outdir, name),
+                         os.O_WRONLY | os.O_CREAT | os.O_TRUNC)
+            os.dup2(fd, f.fileno())
+            os.close(fd)
+    return pid
+
+def _exitChild(code):
+    sys.stdout.flush()
+    sys.stderr.flush()
+    internal.core.doExitCleanup()
+    internal.core.flushOutputDir()
+    os._exit(code)
+
+def sample(system, cpuList, interval, warmup, measure, count=None,
+           max_children=None, simout="%(parent)s/sample%(fork_seq)i"):
+    """Take detailed samples of a fast-forwarding system in parallel.
+
+    Every interval ticks the system is forked. The child switches the
+    CPUs in cpuList (as for switchCpus) and simulates a warmup window
+    followed by a measurement window, for which it dumps the stats to
+    its own output directory (see fork()). The parent meanwhile keeps
+    fast-forwarding, with at most max_children samples running at a
+    time (by default one per host CPU).
+
+    Sampling stops after count samples or when the simulation exits
+    for another reason than the interval ending. Returns the exit
+    event of the parent and a list of (tick, outdir) per sample.
+    """
+    if max_children is None:
+        max_children = os.sysconf("SC_NPROCESSORS_ONLN")
+
+    running = set()
+    samples = []
+    event = None
+    def reap(block):
+        while running:
+            pid, status = os.waitpid(-1, 0 if block else os.WNOHANG)
+            if pid == 0:
+                return
+            running.discard(pid)
+            if status != 0:
+                print "Sample in process %d failed with status %d" % \
+                    (pid, status)
+            if block:
+                return
+
+    while count is None or len(samples) < count:
+        event = simulate(interval)
+        if event.getCause() != "simulate() limit reached":
+            break
+
+        reap(False)
+        while len(running) >= max_children:
+            reap(True)
+
+        outdir = _forkOutdir(simout)
+        pid = fork(simout)
+        if pid == 0:
+            code = 0
+            try:
+                switchCpus(system, cpuList, do_drain=False, verbose=False)
+                simulate(warmup)
+                stats.reset()
+                simulate(measure)
+                stats.dump()
+            except:
+                import traceback
+                traceback.print_exc()
+                code = 1
+            _exitChild(code)
+
+        running.add(pid)
+        samples.append((curTick(), outdir))
+
+    while running:
+        reap(True)
+
+    return event, samples
+
 def _changeMemoryMode(system, mode):
     if not isinstance(system, (objects.Root, objects.System)):
         raise TypeError, "Parameter of type '%s'.  Must be type %s or %s." % \
@@ -39,6 +39,10 @@ def initText(filename, desc=True):
     output = internal.stats.initText(filename, desc)
     outputList.append(output)
 
+def initBinary(filename):
+    output = internal.stats.initBinary(filename)
+    outputList.append(output)
+
 def initSimStats():
     internal.stats.initSimStats()
 
@@ -0,0 +1,142 @@
+# Copyright (c) 2014 The Regents of The University of Michigan
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Reader for statistics written with --stats-binary (Stats::Binary).
+#
+#     from m5.stats import binary
+#     for dump in binary.read('m5out/stats.bin'):
+#         print dump['sim_ticks'], dump['system.cpu.ipc_total']
+#
+# Each dump maps the full name of every value (the statistic name
+# followed by a column suffix such as '::samples' for distributions)
+# to its value.  Sparse histograms map to a dict of bucket to count.
+
+import struct
+
+MAGIC = 'M5STATSB'
+VERSION = 1
+
+SCALAR, VECTOR, DIST, VECTOR_DIST, VECTOR_2D, FORMULA, SPARSE_HIST = range(7)
+
+class Stat(object):
+    def __init__(self, type, name, desc, columns):
+        self.type = type
+        self.name = name
+        self.desc = desc
+        self.columns = columns
+
+    def names(self):
+        return [ self.name + c for c in self.columns ]
+
+class Reader(object):
+    def __init__(self, filename):
+        self.data = bytearray(open(filename, 'rb').read())
+        self.pos = 0
+        if str(self.data[:len(MAGIC)].decode('ascii')) != MAGIC:
+            raise ValueError, "%s is not a binary stats file" % filename
+        self.pos = len(MAGIC)
+        version = self.varint()
+        if version != VERSION:
+            raise ValueError, "Unsupported binary stats version %d" % version
+
+        self.schema = []
+        self.names = []
+        self.values = []
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            b = self.data[self.pos]
+            self.pos += 1
+            value |= (b & 0x7f) << shift
+            if b < 0x80:
+                return value
+            shift += 7
+
+    def string(self):
+        n = self.varint()
+        s = self.data[self.pos:self.pos + n].decode('utf-8')
+        self.pos += n
+        return s
+
+    def double(self):
+        value, = struct.unpack_from('<d', buffer(self.data), self.pos)
+        self.pos += 8
+        return value
+
+    def read_schema(self):
+        self.schema = []
+        for i in xrange(self.varint()):
+            type = self.varint()
+            name = self.string()
+            desc = self.string()
+            columns = [ self.string() for c in xrange(self.varint()) ]
+            self.schema.append(Stat(type, name, desc, columns))
+        self.names = []
+        for stat in self.schema:
+            if stat.type != SPARSE_HIST:
+                self.names.extend(stat.names())
+        self.values = [ 0 ] * len(self.names)
+
+    def read_dump(self):
+        values = self.values
+        i = -1
+        while True:
+            code = self.varint()
+            if code == 0:
+                break
+            i += code >> 1
+            if code & 1:
+                delta = self.varint()
+                values[i] += (delta >> 1) ^ -(delta & 1)
+            else:
+                values[i] = self.double()
+
+        dump = dict(zip(self.names, values))
+        for stat in self.schema:
+            if stat.type == SPARSE_HIST:
+                buckets = {}
+                for j in xrange(self.varint()):
+                    key = self.double()
+                    buckets[key] = self.double()
+                dump[stat.name] = buckets
+        return dump
+
+    def __iter__(self):
+        while self.pos < len(self.data):
+            kind = chr(self.data[self.pos])
+            self.pos += 1
+            if kind == 'S':
+                self.read_schema()
+            elif kind == 'D':
+                yield self.read_dump()
+            else:
+                raise ValueError, "Corrupt binary stats record '%s'" % kind
+
+def read(filename):
+    """Iterate over the dumps in a binary stats file."""
+    return Reader(filename)
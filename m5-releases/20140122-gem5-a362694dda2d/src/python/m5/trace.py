@@ -29,10 +29,17 @@
 import internal
 import util
 
-from internal.trace import output, ignore
+from internal.trace import output, ignore, dumpBinary
 
 def disable():
     internal.trace.cvar.enabled = False
 
 def enable():
     internal.trace.cvar.enabled = True
+
+def binary(filename, size):
+    """Record debug output into per-thread binary ring buffers of size
+    bytes instead of formatting it.  The buffers are written to
+    filename at exit or by dumpBinary(), and can be formatted with
+    util/decode_debug_trace.py."""
+    internal.trace.binary(filename, util.convert.toMemorySize(size))
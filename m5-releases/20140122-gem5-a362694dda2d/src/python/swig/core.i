@@ -69,6 +69,8 @@ seedRandom(uint64_t seed)
 %include "base/types.hh"
 
 void setOutputDir(const std::string &dir);
+void redirectOutputDir(const std::string &dir);
+void flushOutputDir();
 void doExitCleanup();
 void disableAllListeners();
 void seedRandom(uint64_t seed);
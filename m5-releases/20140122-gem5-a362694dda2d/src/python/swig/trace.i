@@ -46,9 +46,23 @@ ignore(const char *expr)
     Trace::ignore.setExpression(expr);
 }
 
+inline void
+binary(const char *filename, size_t size)
+{
+    Trace::enableBinary(filename, size);
+}
+
+inline void
+dumpBinary()
+{
+    Trace::dumpBinary();
+}
+
 using Trace::enabled;
 %}
 
 extern void output(const char *string);
 extern void ignore(const char *expr);
+extern void binary(const char *filename, size_t size);
+extern void dumpBinary();
 extern bool enabled;
@@ -69,6 +69,21 @@ class Root(SimObject):
     # Needs to be set explicitly for a multi-eventq simulation.
     sim_quantum = Param.Tick(0, "simulation quantum")
 
+    # An adaptive quantum grows up to sim_quantum_max while no events
+    # cross between event queues, and shrinks back towards sim_quantum
+    # when they do.  Events that arrive late are delivered immediately.
+    sim_quantum_max = Param.Tick(0, "largest adaptive simulation quantum, "
+                                 "0 keeps the quantum fixed")
+
+    # Lookahead synchronization replaces the quantum barriers: each
+    # queue only waits for the queues that could still send it an
+    # earlier event, given the minimum latency between the two.
+    sim_lookahead = Param.Bool(False, "synchronize event queues by "
+                               "lookahead instead of quantum barriers")
+    sim_link_latency = VectorParam.Tick([], "minimum latency of events "
+        "from event queue i to event queue j at index i * num_queues + j, "
+        "sim_quantum if not given")
+
     full_system = Param.Bool("if this is a full system simulation")
 
     # Time syncing prevents the simulation from running faster than real time.
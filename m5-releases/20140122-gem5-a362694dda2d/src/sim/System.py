@@ -38,6 +38,8 @@ from SimpleMemory import *
 class MemoryMode(Enum): vals = ['invalid', 'atomic', 'timing',
                                 'atomic_noncaching']
 
+class MemCheckpointFormat(Enum): vals = ['gzip', 'paged']
+
 class System(MemObject):
     type = 'System'
     cxx_header = "sim/system.hh"
@@ -58,6 +60,18 @@ class System(MemObject):
                                           "All memories in the system")
     mem_mode = Param.MemoryMode('atomic', "The mode the memory system is in")
 
+    # Paged checkpoints store the memory image uncompressed, one copy
+    # of each distinct non-zero page, and can be restored with mmap.
+    # With a base checkpoint directory, pages that are unchanged since
+    # the base are not stored again but refer to the base image.
+    mem_checkpoint_format = Param.MemCheckpointFormat('gzip',
+        "Format used when checkpointing the memory image")
+    mem_checkpoint_base = Param.String("",
+        "Paged checkpoint that memory checkpoints are incremental to")
+    mem_checkpoint_lazy = Param.Bool(False,
+        "Map paged memory checkpoints on restore and fault pages in "
+        "on demand")
+
     # The memory ranges are to be populated when creating the system
     # such that these can be passed from the I/O subsystem through an
     # I/O bridge or cache
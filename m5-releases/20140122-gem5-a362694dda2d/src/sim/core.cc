@@ -98,6 +98,18 @@ setOutputDir(const string &dir)
     simout.setDirectory(dir);
 }
 
+void
+redirectOutputDir(const string &dir)
+{
+    simout.redirect(dir);
+}
+
+void
+flushOutputDir()
+{
+    simout.flush();
+}
+
 /**
  * Queue of C++ callbacks to invoke on simulator exit.
  */
@@ -94,6 +94,8 @@ extern Tick ps; ///< picosecond
 void setClockFrequency(Tick ticksPerSecond);
 
 void setOutputDir(const std::string &dir);
+void redirectOutputDir(const std::string &dir);
+void flushOutputDir();
 
 class Callback;
 void registerExitCallback(Callback *callback);
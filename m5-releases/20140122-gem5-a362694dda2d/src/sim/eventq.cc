@@ -32,6 +32,7 @@
  *          Steve Raasch
  */
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <string>
@@ -39,6 +40,7 @@
 
 #include "base/hashmap.hh"
 #include "base/misc.hh"
+#include "base/output.hh"
 #include "base/trace.hh"
 #include "cpu/smt.hh"
 #include "debug/Config.hh"
@@ -48,6 +50,9 @@
 using namespace std;
 
 Tick simQuantum = 0;
+Tick simQuantumMax = 0;
+bool simLookahead = false;
+vector<Tick> simLinkLatency;
 
 //
 // Main Event Queues
@@ -114,29 +119,6 @@ Event::insertBefore(Event *event, Event *curr)
     return event;
 }
 
-void
-EventQueue::insert(Event *event)
-{
-    // Deal with the head case
-    if (!head || *event <= *head) {
-        head = Event::insertBefore(event, head);
-        return;
-    }
-
-    // Figure out either which 'in bin' list we are on, or where a new list
-    // needs to be inserted
-    Event *prev = head;
-    Event *curr = head->nextBin;
-    while (curr && *curr < *event) {
-        prev = curr;
-        curr = curr->nextBin;
-    }
-
-    // Note: this operation may render all nextBin pointers on the
-    // prev 'in bin' list stale (except for the top one)
-    prev->nextBin = Event::insertBefore(event, curr);
-}
-
 Event *
 Event::removeItem(Event *event, Event *top)
 {
@@ -168,6 +150,193 @@ Event::removeItem(Event *event, Event *top)
     return top;
 }
 
+#if USE_CALENDAR_EVENTQ
+
+namespace {
+
+//! Orders bins by time and priority when sorting pointers to them.
+struct BinLess
+{
+    bool operator()(const Event *l, const Event *r) const
+    { return *l < *r; }
+};
+
+}
+
+static const size_t calendarMinBuckets = 16;
+static const Tick calendarInitialWidth = 1000;
+
+//! Number of earliest bins used to estimate the bucket width.
+static const size_t calendarWidthSample = 64;
+
+void
+EventQueue::insertBin(Event *bin)
+{
+    Event **link = &buckets[bucketIndex(bin->when())];
+    while (*link && **link < *bin)
+        link = &(*link)->nextBin;
+
+    bin->nextBin = *link;
+    *link = bin;
+}
+
+Event *
+EventQueue::findHead(Tick when) const
+{
+    if (numBins == 0)
+        return NULL;
+
+    // Look for a bin in each slot of the coming "year", in order.
+    // Every bucket is sorted, so only its first bin needs checking.
+    Tick slot = when / bucketWidth;
+    size_t mask = buckets.size() - 1;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        Event *bin = buckets[(slot + i) & mask];
+        if (bin && bin->when() / bucketWidth == slot + i)
+            return bin;
+    }
+
+    // Nothing due within a year, take the earliest first bin
+    Event *earliest = NULL;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        Event *bin = buckets[i];
+        if (bin && (!earliest || *bin < *earliest))
+            earliest = bin;
+    }
+
+    return earliest;
+}
+
+void
+EventQueue::resize(size_t num_buckets)
+{
+    std::vector<Event *> bins;
+    bins.reserve(numBins);
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        for (Event *bin = buckets[i]; bin; bin = bin->nextBin)
+            bins.push_back(bin);
+    }
+
+    // Estimate the bucket width as three times the mean separation
+    // of the earliest bins, ignoring separations more than twice the
+    // overall mean (the method of Brown's original calendar queue).
+    size_t sample = std::min(bins.size(), calendarWidthSample);
+    if (sample > 1) {
+        std::nth_element(bins.begin(), bins.begin() + sample - 1,
+                         bins.end(), BinLess());
+        std::sort(bins.begin(), bins.begin() + sample, BinLess());
+
+        Tick span = bins[sample - 1]->when() - bins[0]->when();
+        Tick limit = 2 * (span / (sample - 1)) + 1;
+        Tick sum = 0;
+        size_t gaps = 0;
+        for (size_t i = 1; i < sample; ++i) {
+            Tick gap = bins[i]->when() - bins[i - 1]->when();
+            if (gap != 0 && gap <= limit) {
+                sum += gap;
+                ++gaps;
+            }
+        }
+
+        if (gaps != 0) {
+            Tick mean = sum / gaps;
+            bucketWidth = mean > MaxTick / 3 ? MaxTick : std::max(3 * mean,
+                                                                  Tick(1));
+        }
+    }
+
+    buckets.assign(num_buckets, NULL);
+    for (size_t i = 0; i < bins.size(); ++i)
+        insertBin(bins[i]);
+}
+
+void
+EventQueue::insert(Event *event)
+{
+    Event **link = &buckets[bucketIndex(event->when())];
+    while (*link && **link < *event)
+        link = &(*link)->nextBin;
+
+    *link = Event::insertBefore(event, *link);
+
+    if (!head || *event <= *head)
+        head = event;
+
+    // event starts a new bin unless it was pushed onto an existing one
+    if (!event->nextInBin && ++numBins > 2 * buckets.size())
+        resize(2 * buckets.size());
+}
+
+void
+EventQueue::remove(Event *event)
+{
+    if (head == NULL)
+        panic("event not found!");
+
+    assert(event->queue == this);
+
+    Event **link = &buckets[bucketIndex(event->when())];
+    while (*link && **link < *event)
+        link = &(*link)->nextBin;
+
+    Event *top = *link;
+    if (!top || *top != *event)
+        panic("event not found!");
+
+    bool last = (event == top && !top->nextInBin);
+    *link = Event::removeItem(event, top);
+
+    if (last)
+        --numBins;
+
+    // only the earliest bin can hold head; *link is the new top of
+    // the bin unless the bin is gone
+    if (*event == *head)
+        head = last ? findHead(event->when()) : *link;
+
+    if (last && numBins < buckets.size() / 2 &&
+        buckets.size() > calendarMinBuckets)
+        resize(buckets.size() / 2);
+}
+
+void
+EventQueue::sortedBins(std::vector<Event *> &bins) const
+{
+    bins.clear();
+    bins.reserve(numBins);
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        for (Event *bin = buckets[i]; bin; bin = bin->nextBin)
+            bins.push_back(bin);
+    }
+
+    std::sort(bins.begin(), bins.end(), BinLess());
+}
+
+#else // !USE_CALENDAR_EVENTQ
+
+void
+EventQueue::insert(Event *event)
+{
+    // Deal with the head case
+    if (!head || *event <= *head) {
+        head = Event::insertBefore(event, head);
+        return;
+    }
+
+    // Figure out either which 'in bin' list we are on, or where a new list
+    // needs to be inserted
+    Event *prev = head;
+    Event *curr = head->nextBin;
+    while (curr && *curr < *event) {
+        prev = curr;
+        curr = curr->nextBin;
+    }
+
+    // Note: this operation may render all nextBin pointers on the
+    // prev 'in bin' list stale (except for the top one)
+    prev->nextBin = Event::insertBefore(event, curr);
+}
+
 void
 EventQueue::remove(Event *event)
 {
@@ -200,13 +369,26 @@ EventQueue::remove(Event *event)
     prev->nextBin = Event::removeItem(event, curr);
 }
 
+void
+EventQueue::sortedBins(std::vector<Event *> &bins) const
+{
+    bins.clear();
+    for (Event *bin = head; bin; bin = bin->nextBin)
+        bins.push_back(bin);
+}
+
+#endif // USE_CALENDAR_EVENTQ
+
 Event *
 EventQueue::serviceOne()
 {
     Event *event = head;
-    Event *next = head->nextInBin;
     event->flags.clear(Event::Scheduled);
 
+#if USE_CALENDAR_EVENTQ
+    remove(event);
+#else
+    Event *next = head->nextInBin;
     if (next) {
         // update the next bin pointer since it could be stale
         next->nextBin = head->nextBin;
@@ -218,12 +400,23 @@ EventQueue::serviceOne()
         // the 'in bin' list and point to the next bin list
         head = head->nextBin;
     }
+#endif
 
     // handle action
     if (!event->squashed()) {
         // forward current cycle to the time when this event occurs.
         setCurTick(event->when());
 
+        if (profile) {
+            // events without a name of their own are counted
+            // together, they cannot be attributed to an object and
+            // every instance would add an entry
+            std::string name = event->name();
+            if (name == event->Event::name())
+                name = "unattributed";
+            ++(*profile)[name];
+        }
+
         event->process();
         if (event->isExitEvent()) {
             assert(!event->flags.isSet(Event::AutoDelete) ||
@@ -294,9 +487,10 @@ EventQueue::serialize(ostream &os)
     std::list<Event *> eventPtrs;
 
     int numEvents = 0;
-    Event *nextBin = head;
-    while (nextBin) {
-        Event *nextInBin = nextBin;
+    std::vector<Event *> bins;
+    sortedBins(bins);
+    for (size_t i = 0; i < bins.size(); ++i) {
+        Event *nextInBin = bins[i];
 
         while (nextInBin) {
             if (nextInBin->flags.isSet(Event::AutoSerialize)) {
@@ -306,8 +500,6 @@ EventQueue::serialize(ostream &os)
             }
             nextInBin = nextInBin->nextInBin;
         }
-
-        nextBin = nextBin->nextBin;
     }
 
     SERIALIZE_SCALAR(numEvents);
@@ -342,18 +534,21 @@ EventQueue::dump() const
     cprintf("EventQueue Dump  (cycle %d)\n", curTick());
     cprintf("------------------------------------------------------------\n");
 
+    if (asyncInserts != 0)
+        cprintf("%d events from other threads in %d batches\n",
+                asyncInserts, asyncBatches);
+
     if (empty())
         cprintf("<No Events>\n");
     else {
-        Event *nextBin = head;
-        while (nextBin) {
-            Event *nextInBin = nextBin;
+        std::vector<Event *> bins;
+        sortedBins(bins);
+        for (size_t i = 0; i < bins.size(); ++i) {
+            Event *nextInBin = bins[i];
             while (nextInBin) {
                 nextInBin->dump();
                 nextInBin = nextInBin->nextInBin;
             }
-
-            nextBin = nextBin->nextBin;
         }
     }
 
@@ -368,9 +563,29 @@ EventQueue::debugVerify() const
     Tick time = 0;
     short priority = 0;
 
-    Event *nextBin = head;
-    while (nextBin) {
-        Event *nextInBin = nextBin;
+    std::vector<Event *> bins;
+    sortedBins(bins);
+
+#if USE_CALENDAR_EVENTQ
+    if (!bins.empty() && head != bins[0]) {
+        cprintf("head is not the earliest event!");
+        head->dump();
+        return false;
+    }
+
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        for (Event *bin = buckets[i]; bin; bin = bin->nextBin) {
+            if (bucketIndex(bin->when()) != i) {
+                cprintf("event in the wrong bucket!");
+                bin->dump();
+                return false;
+            }
+        }
+    }
+#endif
+
+    for (size_t i = 0; i < bins.size(); ++i) {
+        Event *nextInBin = bins[i];
         while (nextInBin) {
             if (nextInBin->when() < time) {
                 cprintf("time goes backwards!");
@@ -395,8 +610,6 @@ EventQueue::debugVerify() const
 
             nextInBin = nextInBin->nextInBin;
         }
-
-        nextBin = nextBin->nextBin;
     }
 
     return true;
@@ -405,9 +618,37 @@ EventQueue::debugVerify() const
 Event*
 EventQueue::replaceHead(Event* s)
 {
+#if USE_CALENDAR_EVENTQ
+    // Hand back the pending bins as a sorted 'nextBin' list, the form
+    // the caller will pass back in later
+    std::vector<Event *> bins;
+    sortedBins(bins);
+    for (size_t i = 0; i < bins.size(); ++i)
+        bins[i]->nextBin = i + 1 < bins.size() ? bins[i + 1] : NULL;
+    Event* t = bins.empty() ? NULL : bins[0];
+
+    buckets.assign(buckets.size(), NULL);
+    numBins = 0;
+    head = s;
+    while (s) {
+        Event *next = s->nextBin;
+        insertBin(s);
+        ++numBins;
+        s = next;
+    }
+
+    size_t num_buckets = buckets.size();
+    while (numBins > 2 * num_buckets)
+        num_buckets *= 2;
+    if (num_buckets != buckets.size())
+        resize(num_buckets);
+
+    return t;
+#else
     Event* t = head;
     head = s;
     return t;
+#endif
 }
 
 void
@@ -418,6 +659,53 @@ dumpMainQueue()
     }
 }
 
+void
+EventQueue::profileEvents(bool enable)
+{
+    delete profile;
+    profile = enable ? new std::map<std::string, Counter> : NULL;
+}
+
+void
+EventQueue::eventProfile(std::map<std::string, Counter> &counts) const
+{
+    if (!profile)
+        return;
+
+    std::map<std::string, Counter>::const_iterator i;
+    for (i = profile->begin(); i != profile->end(); ++i)
+        counts[i->first] += i->second;
+}
+
+void
+startEventProfile()
+{
+    for (uint32_t i = 0; i < numMainEventQueues; ++i)
+        mainEventQueue[i]->profileEvents(true);
+}
+
+void
+dumpEventProfile(const std::string &filename)
+{
+    std::map<std::string, Counter> counts;
+    for (uint32_t i = 0; i < numMainEventQueues; ++i)
+        mainEventQueue[i]->eventProfile(counts);
+
+    std::vector<std::pair<Counter, std::string> > sorted;
+    std::map<std::string, Counter>::const_iterator i;
+    for (i = counts.begin(); i != counts.end(); ++i)
+        sorted.push_back(std::make_pair(i->second, i->first));
+    std::sort(sorted.rbegin(), sorted.rend());
+
+    std::ostream *os = simout.create(filename);
+    for (size_t j = 0; j < sorted.size(); ++j)
+        ccprintf(*os, "%d %s\n", sorted[j].first, sorted[j].second);
+    simout.close(os);
+
+    for (uint32_t j = 0; j < numMainEventQueues; ++j)
+        mainEventQueue[j]->profileEvents(false);
+}
+
 
 const char *
 Event::description() const
@@ -459,29 +747,64 @@ Event::dump() const
 }
 
 EventQueue::EventQueue(const string &n)
-    : objName(n), head(NULL), _curTick(0),
-    async_queue_mutex(new std::mutex())
+    : objName(n), head(NULL), _curTick(0), asyncHead(NULL),
+      asyncInserts(0), asyncBatches(0), asyncLate(0), syncWait(0),
+      syncArrival(0), profile(NULL)
+#if USE_CALENDAR_EVENTQ
+    , buckets(calendarMinBuckets, NULL), bucketWidth(calendarInitialWidth),
+    numBins(0)
+#endif
 {
 }
 
 void
 EventQueue::asyncInsert(Event *event)
 {
-    async_queue_mutex->lock();
-    async_queue.push_back(event);
-    async_queue_mutex->unlock();
+    Event *next = asyncHead.load(std::memory_order_relaxed);
+    do {
+        event->nextBin = next;
+    } while (!asyncHead.compare_exchange_weak(next, event,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
 }
 
 void
 EventQueue::handleAsyncInsertions()
 {
     assert(this == curEventQueue());
-    async_queue_mutex->lock();
 
-    while (!async_queue.empty()) {
-        insert(async_queue.front());
-        async_queue.pop_front();
+    Event *list = asyncHead.exchange(NULL, std::memory_order_acquire);
+    if (!list)
+        return;
+
+    // The list is newest first; reverse it so that events are inserted
+    // in the order they were scheduled, which keeps global events in
+    // the same order on every queue
+    Event *event = NULL;
+    while (list) {
+        Event *next = list->nextBin;
+        list->nextBin = event;
+        event = list;
+        list = next;
+    }
+
+    while (event) {
+        Event *next = event->nextBin;
+
+        if (event->when() < _curTick) {
+            // sent with less lookahead than the synchronization
+            // allowed; a relaxed (adaptive) quantum accepts this and
+            // delivers the event now
+            ++asyncLate;
+            if (simQuantumMax > simQuantum)
+                event->_when = _curTick;
+        }
+
+        insert(event);
+        if (!event->globalEvent())
+            ++asyncInserts;
+        event = next;
     }
 
-    async_queue_mutex->unlock();
+    ++asyncBatches;
 }
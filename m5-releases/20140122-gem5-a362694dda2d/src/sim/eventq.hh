@@ -39,15 +39,19 @@
 #define __SIM_EVENTQ_HH__
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <iosfwd>
+#include <map>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "base/flags.hh"
 #include "base/misc.hh"
 #include "base/types.hh"
+#include "config/use_calendar_eventq.hh"
 #include "debug/Event.hh"
 #include "sim/serialize.hh"
 
@@ -61,6 +65,24 @@ class BaseGlobalEvent;
 //! Queue B should be at least simQuantum ticks away in future.
 extern Tick simQuantum;
 
+//! Largest quantum for adaptive quantum synchronization.  When it is
+//! larger than simQuantum, the quantum doubles after each quantum in
+//! which no events crossed between queues and halves, down to
+//! simQuantum, after each one in which some did.  Events that arrive
+//! in a queue's past are then delivered at the queue's current tick.
+extern Tick simQuantumMax;
+
+//! Synchronize the queues pairwise instead of with quantum barriers.
+//! A queue only processes events earlier than every other queue's
+//! published time plus the lookahead between the two queues.
+extern bool simLookahead;
+
+//! Minimum latency of events sent from queue i to queue j, at index
+//! i * numMainEventQueues + j, for lookahead synchronization.  Pairs
+//! that are not listed, or that are further apart than simQuantum,
+//! use simQuantum.
+extern std::vector<Tick> simLinkLatency;
+
 //! Current number of allocated main event queues.
 extern uint32_t numMainEventQueues;
 
@@ -188,7 +210,9 @@ class Event : public EventBase, public Serializable
     // result is that the insert/removal in 'nextBin' is
     // linear/constant, and the lookup/removal in 'nextInBin' is
     // constant/constant.  Hopefully this is a significant improvement
-    // over the current fully linear insertion.
+    // over the current fully linear insertion.  With
+    // USE_CALENDAR_EVENTQ the 'nextBin' lists are kept per calendar
+    // bucket instead (see EventQueue).
     Event *nextBin;
     Event *nextInBin;
 
@@ -408,11 +432,62 @@ class EventQueue : public Serializable
     Event *head;
     Tick _curTick;
 
-    //! Mutex to protect async queue.
-    std::mutex *async_queue_mutex;
+    //! Events added by other threads to this event queue, most
+    //! recent first.  The events are linked through their nextBin
+    //! fields, which are unused until the owning thread inserts them.
+    //! Any thread may push, only the owning thread takes the list.
+    std::atomic<Event *> asyncHead;
+
+    //! Events from other queues moved from the async list into this
+    //! queue (global synchronization events are not counted), the
+    //! number of handleAsyncInsertions() calls that found any, and
+    //! the events that arrived after this queue had passed their
+    //! tick.  Updated by the owning thread only.
+    Counter asyncInserts;
+    Counter asyncBatches;
+    Counter asyncLate;
+
+    //! Host seconds this queue's thread spent waiting for other
+    //! queues, and the host time at which it last arrived at a
+    //! quantum barrier.
+    double syncWait;
+    double syncArrival;
+
+    //! Processed events counted by name while profiling, else NULL.
+    //! Events without a name of their own share one entry.
+    std::map<std::string, Counter> *profile;
+
+#if USE_CALENDAR_EVENTQ
+    //! Calendar queue of bins.  Time is divided into slots of
+    //! bucketWidth ticks and slot i maps to bucket i modulo the
+    //! number of buckets (a power of two).  Each bucket holds a short
+    //! sorted list of bins linked by nextBin, and head always points
+    //! to the earliest bin.  The number of buckets follows the number
+    //! of bins, and the width is re-estimated from the spacing of the
+    //! earliest bins every time the calendar is resized, so insertion
+    //! and removal take constant amortized time.
+    std::vector<Event *> buckets;
+    Tick bucketWidth;
+    size_t numBins;
+
+    size_t
+    bucketIndex(Tick when) const
+    {
+        return (when / bucketWidth) & (buckets.size() - 1);
+    }
+
+    //! Add a whole bin to its bucket.  Does not update head or numBins.
+    void insertBin(Event *bin);
 
-    //! List of events added by other threads to this event queue.
-    std::list<Event*> async_queue;
+    //! Find the earliest bin, given that none is earlier than when.
+    Event *findHead(Tick when) const;
+
+    //! Redistribute the bins over num_buckets buckets.
+    void resize(size_t num_buckets);
+#endif
+
+    //! Collect the top event of every bin in time order.
+    void sortedBins(std::vector<Event *> &bins) const;
 
     //! Insert / remove event from the queue. Should only be called
     //! by thread operating this queue.
@@ -478,9 +553,36 @@ class EventQueue : public Serializable
 
     bool debugVerify() const;
 
-    //! Function for moving events from the async_queue to the main queue.
+    //! Function for moving events from the async list to the main queue.
     void handleAsyncInsertions();
 
+    Counter numAsyncInserts() const { return asyncInserts; }
+    Counter numAsyncBatches() const { return asyncBatches; }
+    Counter numLateAsyncEvents() const { return asyncLate; }
+
+    //! True if other threads have scheduled events on this queue that
+    //! have not been inserted yet.
+    bool
+    asyncPending() const
+    {
+        return asyncHead.load(std::memory_order_relaxed) != NULL;
+    }
+
+    double syncWaitSeconds() const { return syncWait; }
+    void addSyncWait(double seconds) { syncWait += seconds; }
+
+    double syncArrivalTime() const { return syncArrival; }
+    void syncArrivalTime(double t) { syncArrival = t; }
+
+#ifndef SWIG
+    //! Start (discarding any earlier counts) or stop counting the
+    //! events this queue processes by name.
+    void profileEvents(bool enable);
+
+    //! Add the counts of the current or last profile to counts.
+    void eventProfile(std::map<std::string, Counter> &counts) const;
+#endif
+
     /**
      *  function for replacing the head of the event queue, so that a
      *  different set of events can run without disturbing events that have
@@ -499,6 +601,15 @@ class EventQueue : public Serializable
 
 void dumpMainQueue();
 
+//! Count the events processed on every main queue by event name, for
+//! instance to estimate the cost of each SimObject before assigning
+//! objects to event queues.
+void startEventProfile();
+
+//! Stop profiling and write "count name" lines, most frequent first,
+//! to the named file in the output directory.
+void dumpEventProfile(const std::string &filename);
+
 #ifndef SWIG
 class EventManager
 {
@@ -41,12 +41,20 @@
 inline void
 EventQueue::schedule(Event *event, Tick when, bool global)
 {
-    assert(when >= getCurTick());
+    // with an adaptive quantum, events from other queues may be late;
+    // handleAsyncInsertions() delivers them at the queue's current tick
+    assert(when >= getCurTick() ||
+           (inParallelMode && this != curEventQueue() &&
+            simQuantumMax > simQuantum));
     assert(!event->scheduled());
     assert(event->initialized());
 
     event->setWhen(when, this);
 
+    // Mark the event before publishing it: once on another thread's
+    // async list the owner may dispatch it at any time.
+    event->flags.set(Event::Scheduled);
+
     // The check below is to make sure of two things
     // a. a thread schedules local events on other queues through the asyncq
     // b. a thread schedules global events on the asyncq, whether or not
@@ -58,7 +66,6 @@ EventQueue::schedule(Event *event, Tick when, bool global)
     } else {
         insert(event);
     }
-    event->flags.set(Event::Scheduled);
 
     if (DTRACE(Event))
         event->trace("scheduled");
@@ -29,6 +29,8 @@
  * Authors: Steve Reinhardt
  */
 
+#include "base/time.hh"
+#include "debug/SyncQuantum.hh"
 #include "sim/global_event.hh"
 
 std::mutex BaseGlobalEvent::globalQMutex;
@@ -140,6 +142,10 @@ GlobalEvent::BarrierEvent::process()
 void
 GlobalSyncEvent::BarrierEvent::process()
 {
+    Time now;
+    now.setTimer();
+    curEventQueue()->syncArrivalTime(now);
+
     // wait for all queues to arrive at barrier, then process event
     if (globalBarrier()) {
         _globalEvent->process();
@@ -154,6 +160,33 @@ GlobalSyncEvent::BarrierEvent::process()
 void
 GlobalSyncEvent::process()
 {
+    // Every other thread is blocked in the barrier, so this thread may
+    // look at all the queues.  The last thread to arrive runs this, so
+    // each queue waited from its arrival until now.
+    Time now;
+    now.setTimer();
+    double now_sec = now;
+
+    bool crossed = false;
+    for (uint32_t i = 0; i < numMainEventQueues; ++i) {
+        EventQueue *q = mainEventQueue[i];
+        double wait = now_sec - q->syncArrivalTime();
+        q->addSyncWait(wait);
+        crossed = crossed || q->asyncPending();
+
+        DPRINTF(SyncQuantum, "%s waited %.6fs\n", q->name(), wait);
+    }
+
+    if (maxRepeat > minRepeat) {
+        if (crossed)
+            repeat = std::max(minRepeat, repeat / 2);
+        else
+            repeat = std::min(maxRepeat, repeat * 2);
+    }
+
+    DPRINTF(SyncQuantum, "%s cross-queue events, next quantum %d\n",
+            crossed ? "had" : "no", repeat);
+
     if (repeat) {
         schedule(curTick() + repeat);
     }
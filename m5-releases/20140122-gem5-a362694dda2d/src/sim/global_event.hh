@@ -214,7 +214,8 @@ class GlobalSyncEvent : public BaseGlobalEventTemplate<GlobalSyncEvent>
     { }
 
     GlobalSyncEvent(Tick when, Tick _repeat, Priority p, Flags f)
-        : Base(p, f), repeat(_repeat)
+        : Base(p, f), repeat(_repeat), minRepeat(_repeat),
+          maxRepeat(_repeat)
     {
         schedule(when);
     }
@@ -223,7 +224,18 @@ class GlobalSyncEvent : public BaseGlobalEventTemplate<GlobalSyncEvent>
 
     const char *description() const;
 
+    /**
+     * Let the repeat interval vary between its initial value and
+     * max_repeat: it doubles after an interval in which no events
+     * crossed between queues and halves after one in which some did.
+     */
+    void adaptive(Tick max_repeat) { maxRepeat = max_repeat; }
+
     Tick repeat;
+
+  private:
+    Tick minRepeat;
+    Tick maxRepeat;
 };
 
 
@@ -46,7 +46,10 @@
 #include <unistd.h>
 
 #include <cstdio>
+#include <cstring>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "base/loader/object_file.hh"
 #include "base/loader/symtab.hh"
@@ -54,6 +57,7 @@
 #include "base/statistics.hh"
 #include "config/the_isa.hh"
 #include "cpu/thread_context.hh"
+#include "debug/Loader.hh"
 #include "mem/page_table.hh"
 #include "mem/se_translating_port_proxy.hh"
 #include "params/LiveProcess.hh"
@@ -603,6 +607,86 @@ LiveProcess::getSyscallArg(ThreadContext *tc, int &i, int width)
     return getSyscallArg(tc, i);
 }
 
+bool LiveProcess::shareText = false;
+
+namespace {
+
+/** A text image loaded into physical pages that may be shared. */
+struct SharedText
+{
+    System *system;
+    Addr textBase;
+    size_t textSize;
+    const uint8_t *image;   // owned by the first process's ObjectFile
+    Addr paddr;             // physical address of the first whole page
+};
+
+std::vector<SharedText> sharedTexts;
+std::mutex sharedTextMutex;
+
+}
+
+void
+LiveProcess::initState()
+{
+    Process::initState();
+
+    if (shareText)
+        mapSharedText();
+}
+
+void
+LiveProcess::mapSharedText()
+{
+    const uint8_t *image = objFile->textImage();
+    Addr text_base = objFile->textBase();
+    size_t text_size = objFile->textSize();
+    if (!image || text_size == 0)
+        return;
+
+    Addr start = roundUp(text_base, (Addr)VMPageSize);
+    Addr end = roundDown(text_base + text_size, (Addr)VMPageSize);
+
+    // pages holding any data or bss must stay private
+    Addr data_start = roundDown(objFile->dataBase(), (Addr)VMPageSize);
+    Addr data_end = roundUp(objFile->bssBase() + objFile->bssSize(),
+                            (Addr)VMPageSize);
+    if (objFile->dataSize() + objFile->bssSize() != 0 &&
+        data_start < end && data_end > start) {
+        if (data_start <= start)
+            return;
+        end = data_start;
+    }
+
+    if (end <= start)
+        return;
+
+    int npages = (end - start) / VMPageSize;
+
+    std::lock_guard<std::mutex> lock(sharedTextMutex);
+
+    std::vector<SharedText>::const_iterator t = sharedTexts.begin();
+    for (; t != sharedTexts.end(); ++t) {
+        if (t->system == system && t->textBase == text_base &&
+            t->textSize == text_size &&
+            memcmp(t->image, image, text_size) == 0) {
+            DPRINTF(Loader, "%s: sharing %d text pages at %#x\n",
+                    name(), npages, start);
+            pTable->map(start, t->paddr, end - start);
+            return;
+        }
+    }
+
+    SharedText text;
+    text.system = system;
+    text.textBase = text_base;
+    text.textSize = text_size;
+    text.image = image;
+    text.paddr = system->allocPhysPages(npages);
+    pTable->map(start, text.paddr, end - start);
+    sharedTexts.push_back(text);
+}
+
 LiveProcess *
 LiveProcess::create(LiveProcessParams * params)
 {
@@ -243,6 +243,17 @@ class LiveProcess : public Process
 
     LiveProcess(LiveProcessParams *params, ObjectFile *objFile);
 
+    void initState();
+
+    /**
+     * Map the whole pages of the text segment to physical pages shared
+     * with any earlier process in the same system that loaded an
+     * identical text image. The first process with a given image
+     * allocates the pages. Called before the sections are loaded, so
+     * loading only rewrites identical bytes into shared pages.
+     */
+    void mapSharedText();
+
     // Id of the owner of the process
     uint64_t __uid;
     uint64_t __euid;
@@ -255,6 +266,13 @@ class LiveProcess : public Process
 
   public:
 
+    /**
+     * Share the physical pages holding read-only text between processes
+     * running identical executables. Off by default. Set by HAsim,
+     * which runs many copies of the same workload.
+     */
+    static bool shareText;
+
     enum AuxiliaryVectorType {
         M5_AT_NULL = 0,
         M5_AT_IGNORE = 1,
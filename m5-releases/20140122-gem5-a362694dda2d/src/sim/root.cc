@@ -114,6 +114,9 @@ Root::Root(RootParams *p) : SimObject(p), _enabled(false),
     lastTime.setTimer();
 
     simQuantum = p->sim_quantum;
+    simQuantumMax = p->sim_quantum_max;
+    simLookahead = p->sim_lookahead;
+    simLinkLatency = p->sim_link_latency;
 }
 
 void
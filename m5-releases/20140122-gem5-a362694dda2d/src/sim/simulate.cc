@@ -31,11 +31,13 @@
  *          Steve Reinhardt
  */
 
+#include <atomic>
 #include <mutex>
 #include <thread>
 
 #include "base/misc.hh"
 #include "base/pollevent.hh"
+#include "base/time.hh"
 #include "base/types.hh"
 #include "sim/async.hh"
 #include "sim/eventq_impl.hh"
@@ -51,9 +53,82 @@ std::mutex asyncEventMutex;
 //! simulation loop.
 Barrier *threadBarrier;
 
+//! Lookahead synchronization state.  Each queue publishes a lower
+//! bound on the tick of anything it will process from now on, and so
+//! on the tick of anything it can still send, less the latency to the
+//! receiving queue.
+struct PublishedTick
+{
+    std::atomic<Tick> tick;
+    char pad[64 - sizeof(std::atomic<Tick>)];
+};
+
+static PublishedTick *publishedTick = NULL;
+
+//! Lookahead from queue i to queue j at i * numMainEventQueues + j.
+static std::vector<Tick> lookahead;
+
 //! forward declaration
 Event *doSimLoop(EventQueue *);
 
+/**
+ * Set up lookahead synchronization: derive the lookahead between each
+ * pair of queues from simLinkLatency and simQuantum, and publish every
+ * queue's current tick.
+ */
+static void
+initLookahead()
+{
+    uint32_t n = numMainEventQueues;
+
+    if (!simLinkLatency.empty() && simLinkLatency.size() != n * n)
+        fatal("sim_link_latency has %d entries for %d event queues\n",
+              simLinkLatency.size(), n);
+
+    // Global events are scheduled simQuantum ahead, so no queue may run
+    // further ahead of another than that.  A lookahead of zero could
+    // never let a queue make progress.
+    lookahead.assign(n * n, simQuantum);
+    for (uint32_t i = 0; i < simLinkLatency.size(); ++i) {
+        Tick l = std::min(simLinkLatency[i], simQuantum);
+        lookahead[i] = std::max(l, Tick(1));
+    }
+
+    // A queue's own global events also go through its async list,
+    // scheduled at least simQuantum ahead
+    for (uint32_t i = 0; i < n; ++i)
+        lookahead[i * n + i] = simQuantum;
+
+    if (!publishedTick)
+        publishedTick = new PublishedTick[n];
+
+    for (uint32_t i = 0; i < n; ++i)
+        publishedTick[i].tick.store(mainEventQueue[i]->getCurTick());
+}
+
+/**
+ * Compute how far queue index may run: the earliest tick at which any
+ * queue, including itself through a global event, could still
+ * schedule an event on it.  Events already sent are inserted; anything
+ * sent later is no earlier than the bound.
+ */
+static Tick
+lookaheadBound(EventQueue *eventq, uint32_t index)
+{
+    uint32_t n = numMainEventQueues;
+    Tick bound = MaxTick;
+
+    for (uint32_t i = 0; i < n; ++i) {
+        Tick t = publishedTick[i].tick.load(std::memory_order_acquire);
+        Tick l = lookahead[i * n + index];
+        if (t < MaxTick - l)
+            bound = std::min(bound, t + l);
+    }
+
+    eventq->handleAsyncInsertions();
+    return bound;
+}
+
 /**
  * The main function for all subordinate threads (i.e., all threads
  * other than the main thread).  These threads start by waiting on
@@ -114,8 +189,14 @@ simulate(Tick num_cycles)
             fatal("Quantum for multi-eventq simulation not specified");
         }
 
-        quantum_event = new GlobalSyncEvent(simQuantum, simQuantum,
-                            EventBase::Progress_Event_Pri, 0);
+        if (simLookahead) {
+            initLookahead();
+        } else {
+            quantum_event = new GlobalSyncEvent(simQuantum, simQuantum,
+                                EventBase::Progress_Event_Pri, 0);
+            if (simQuantumMax > simQuantum)
+                quantum_event->adaptive(simQuantumMax);
+        }
 
         inParallelMode = true;
     }
@@ -185,10 +266,49 @@ doSimLoop(EventQueue *eventq)
     curEventQueue(eventq);
     eventq->handleAsyncInsertions();
 
+    bool lookahead_sync = inParallelMode && simLookahead;
+    uint32_t index = 0;
+    while (mainEventQueue[index] != eventq)
+        ++index;
+    Tick bound = 0;
+
     while (1) {
         // there should always be at least one event (the SimLoopExitEvent
         // we just scheduled) in the queue
         assert(!eventq->empty());
+
+        if (lookahead_sync) {
+            // Wait until no other queue can send us anything earlier
+            // than our next event, publishing our own bound meanwhile
+            // so that the queues we wait for can progress.
+            Time wait_start;
+            bool waited = false;
+            while (eventq->nextTick() >= bound) {
+                bound = lookaheadBound(eventq, index);
+                if (eventq->nextTick() < bound)
+                    break;
+
+                publishedTick[index].tick.store(
+                    std::min(eventq->nextTick(), bound),
+                    std::memory_order_release);
+
+                if (!waited) {
+                    wait_start.setTimer();
+                    waited = true;
+                }
+                std::this_thread::yield();
+            }
+
+            if (waited) {
+                Time now;
+                now.setTimer();
+                eventq->addSyncWait(now - wait_start);
+            }
+
+            publishedTick[index].tick.store(eventq->nextTick(),
+                                            std::memory_order_release);
+        }
+
         assert(curTick() <= eventq->nextTick() &&
                "event scheduled in the past");
 
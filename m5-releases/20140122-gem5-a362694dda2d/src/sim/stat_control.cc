@@ -46,6 +46,7 @@
 // This file will contain default statistics for the simulator that
 // don't really belong to a specific simulator object
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <list>
@@ -105,6 +106,42 @@ statFinalTick()
 
 SimTicksReset simTicksReset;
 
+Counter
+numAsyncEvents()
+{
+    Counter total = 0;
+    for (uint32_t i = 0; i < numMainEventQueues; ++i)
+        total += mainEventQueue[i]->numAsyncInserts();
+    return total;
+}
+
+Counter
+numLateAsyncEvents()
+{
+    Counter total = 0;
+    for (uint32_t i = 0; i < numMainEventQueues; ++i)
+        total += mainEventQueue[i]->numLateAsyncEvents();
+    return total;
+}
+
+double
+syncWaitSeconds()
+{
+    double total = 0;
+    for (uint32_t i = 0; i < numMainEventQueues; ++i)
+        total += mainEventQueue[i]->syncWaitSeconds();
+    return total;
+}
+
+double
+maxSyncWaitSeconds()
+{
+    double max_wait = 0;
+    for (uint32_t i = 0; i < numMainEventQueues; ++i)
+        max_wait = std::max(max_wait, mainEventQueue[i]->syncWaitSeconds());
+    return max_wait;
+}
+
 struct Global
 {
     Stats::Formula hostInstRate;
@@ -116,6 +153,11 @@ struct Global
     Stats::Value simInsts;
     Stats::Value simOps;
 
+    Stats::Value hostAsyncEvents;
+    Stats::Value hostLateAsyncEvents;
+    Stats::Value hostSyncWait;
+    Stats::Value hostSyncWaitMax;
+
     Global();
 };
 
@@ -189,6 +231,38 @@ Global::Global()
         .precision(2)
         ;
 
+    hostAsyncEvents
+        .functor(numAsyncEvents)
+        .name("host_async_events")
+        .desc("Events scheduled across event queue threads")
+        .precision(0)
+        .prereq(hostAsyncEvents)
+        ;
+
+    hostLateAsyncEvents
+        .functor(numLateAsyncEvents)
+        .name("host_late_async_events")
+        .desc("Events from other event queues that arrived after their tick")
+        .precision(0)
+        .prereq(hostLateAsyncEvents)
+        ;
+
+    hostSyncWait
+        .functor(syncWaitSeconds)
+        .name("host_sync_wait")
+        .desc("Real time event queue threads spent waiting for each other")
+        .precision(2)
+        .prereq(hostSyncWait)
+        ;
+
+    hostSyncWaitMax
+        .functor(maxSyncWaitSeconds)
+        .name("host_sync_wait_max")
+        .desc("Largest real time a single event queue thread waited")
+        .precision(2)
+        .prereq(hostSyncWait)
+        ;
+
     hostTickRate
         .name("host_tick_rate")
         .desc("Simulator tick rate (ticks/s)")
@@ -80,7 +80,9 @@ System::System(Params *p)
       physProxy(_systemPort, p->cache_line_size),
       loadAddrMask(p->load_addr_mask),
       nextPID(0),
-      physmem(name() + ".physmem", p->memories),
+      physmem(name() + ".physmem", p->memories, p->mem_checkpoint_format,
+              p->mem_checkpoint_base, p->mem_checkpoint_lazy),
+      lazyTouchedPagesFunc(physmem),
       memoryMode(p->mem_mode),
       _cacheLineSize(p->cache_line_size),
       workItemsBegin(0),
@@ -309,6 +311,7 @@ System::replaceThreadContext(ThreadContext *tc, int context_id)
 Addr
 System::allocPhysPages(int npages)
 {
+    std::lock_guard<std::mutex> lock(pagePtrMutex);
     Addr return_addr = pagePtr << LogVMPageSize;
     pagePtr += npages;
     if ((pagePtr << LogVMPageSize) > physmem.totalSize())
@@ -388,6 +391,13 @@ System::regStats()
                          .desc("Run time stat for" + namestr.str())
                          .prereq(*workItemStats[j]);
     }
+
+    lazyTouchedPages
+        .functor(lazyTouchedPagesFunc)
+        .name(name() + ".physmem_touched_pages")
+        .desc("Pages of lazily restored memory touched since the restore")
+        .prereq(lazyTouchedPages)
+        ;
 }
 
 void
@@ -47,6 +47,7 @@
 #ifndef __SYSTEM_HH__
 #define __SYSTEM_HH__
 
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -208,6 +209,10 @@ class System : public MemObject
 
     Addr pagePtr;
 
+    /** Serializes allocPhysPages() when HAsim emulates processes on
+     * multiple host threads. */
+    std::mutex pagePtrMutex;
+
     uint64_t init_param;
 
     /** Port to physical memory used for writing object files into ram at
@@ -268,6 +273,21 @@ class System : public MemObject
 
     PhysicalMemory physmem;
 
+    /** Functor reporting the touched pages of a lazy restore */
+    struct LazyTouchedPages
+    {
+        const PhysicalMemory& physmem;
+        LazyTouchedPages(const PhysicalMemory& _physmem)
+            : physmem(_physmem)
+        {}
+        Counter operator()() const { return physmem.lazyTouchedPages(); }
+    };
+
+    LazyTouchedPages lazyTouchedPagesFunc;
+
+    /** Pages of lazily restored memory touched since the restore */
+    Stats::Value lazyTouchedPages;
+
     Enums::MemoryMode memoryMode;
 
     const unsigned int _cacheLineSize;
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file Checks that ElasticGen issues the accesses of an elastic trace
+ * when their dependencies allow, by replaying traces against a memory
+ * with a fixed latency and comparing every issue tick to a model of the
+ * replay rules.
+ */
+
+#include <unistd.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/random.hh"
+#include "base/types.hh"
+#include "cpu/testers/traffic_gen/generators.hh"
+#include "proto/inst_dep_record.pb.h"
+#include "proto/protoio.hh"
+#include "sim/core.hh"
+#include "sim/eventq.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+using UnitTest::setCase;
+
+namespace {
+
+const char *traceFile = "elasticgentest.trc";
+
+/** A record of a test trace. */
+struct Record
+{
+    bool load;
+    /** Distances back to the records this one depends on. */
+    vector<uint64_t> deps;
+    Tick compDelay;
+    unsigned weight;
+};
+
+void
+writeTrace(const vector<Record> &records, unsigned window)
+{
+    ProtoOutputStream trace(traceFile);
+
+    Message::InstDepRecordHeader header;
+    header.set_obj_id("test");
+    header.set_tick_freq(SimClock::Frequency);
+    header.set_window_size(window);
+    trace.write(header);
+
+    for (uint64_t id = 0; id < records.size(); ++id) {
+        const Record &r = records[id];
+        Message::InstDepRecord rec;
+        rec.set_type(r.load ? Message::InstDepRecord::LOAD :
+                     Message::InstDepRecord::STORE);
+        // the address identifies the record in the replay
+        rec.set_p_addr(id * 64);
+        rec.set_size(8);
+        for (size_t d = 0; d < r.deps.size(); ++d)
+            rec.add_reg_dep(r.deps[d]);
+        rec.set_comp_delay(r.compDelay);
+        rec.set_weight(r.weight);
+        trace.write(rec);
+    }
+}
+
+void
+setTick(Tick when)
+{
+    curEventQueue()->setCurTick(when);
+}
+
+/**
+ * Replay the trace against a memory that responds to every load after
+ * a fixed latency.
+ * @return The issue tick of every record, MaxTick if not issued.
+ */
+vector<Tick>
+replay(size_t num_records, unsigned window, Tick latency)
+{
+    vector<Tick> issued(num_records, MaxTick);
+
+    setTick(0);
+    ElasticGen gen("gen", 0, MaxTick, traceFile, 0, window);
+    gen.enter();
+
+    multimap<Tick, PacketPtr> responses;
+    while (true) {
+        Tick next_packet = gen.nextPacketTick(true, 0);
+        Tick next_response =
+            responses.empty() ? MaxTick : responses.begin()->first;
+        if (next_packet == MaxTick && next_response == MaxTick)
+            break;
+
+        if (next_response <= next_packet) {
+            setTick(next_response);
+            PacketPtr pkt = responses.begin()->second;
+            responses.erase(responses.begin());
+            gen.recvResponse(pkt);
+            delete pkt->req;
+            delete pkt;
+        } else {
+            setTick(next_packet);
+            PacketPtr pkt = gen.getNextPacket();
+            uint64_t id = pkt->getAddr() / 64;
+            if (id < num_records && issued[id] == MaxTick)
+                issued[id] = next_packet;
+            if (pkt->isRead()) {
+                responses.insert(make_pair(next_packet + latency, pkt));
+            } else {
+                delete pkt->req;
+                delete pkt;
+            }
+        }
+    }
+
+    gen.exit();
+    return issued;
+}
+
+/**
+ * The issue ticks of the records by the replay rules. A record enters
+ * the window once every record at least a window of instructions
+ * older has completed, in order. A record with dependencies issues
+ * its compute delay after the last of them completes, loads on their
+ * response and stores on issue. A record without any issues its
+ * compute delay after the previous such record, or the start. The
+ * player only remembers when the last two windows of records
+ * completed, older dependencies count as completed at the start.
+ */
+vector<Tick>
+expectedIssue(const vector<Record> &records, unsigned window, Tick latency)
+{
+    size_t n = records.size();
+    vector<Tick> issue(n), done(n);
+    vector<uint64_t> inst(n);
+
+    uint64_t remembered = 1;
+    while (remembered < 2 * window)
+        remembered <<= 1;
+
+    uint64_t count = 0;
+    Tick last_indep_issue = 0;
+    // completion tick of the oldest records, in order
+    Tick retired = 0;
+    size_t num_retired = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        count += records[i].weight;
+        inst[i] = count;
+
+        while (num_retired < i && inst[i] - inst[num_retired] >= window) {
+            retired = max(retired, done[num_retired]);
+            ++num_retired;
+        }
+        Tick admitted = retired;
+
+        Tick ready = 0;
+        const vector<uint64_t> &deps = records[i].deps;
+        if (deps.empty()) {
+            ready = last_indep_issue + records[i].compDelay;
+        } else {
+            for (size_t d = 0; d < deps.size(); ++d) {
+                Tick dep_done = deps[d] <= remembered ? done[i - deps[d]] : 0;
+                ready = max(ready, dep_done + records[i].compDelay);
+            }
+        }
+
+        issue[i] = max(ready, admitted);
+        done[i] = issue[i] + (records[i].load ? latency : 0);
+        if (deps.empty())
+            last_indep_issue = issue[i];
+    }
+    return issue;
+}
+
+bool
+replayMatches(const vector<Record> &records, unsigned window, Tick latency)
+{
+    writeTrace(records, window);
+    vector<Tick> issued = replay(records.size(), 0, latency);
+    unlink(traceFile);
+    return issued == expectedIssue(records, window, latency);
+}
+
+/** Loads, each depending on the one before. */
+vector<Record>
+chainTrace(size_t n, Tick delay)
+{
+    vector<Record> records(n);
+    for (size_t i = 0; i < n; ++i) {
+        records[i].load = true;
+        if (i > 0)
+            records[i].deps.push_back(1);
+        records[i].compDelay = delay;
+        records[i].weight = 1;
+    }
+    return records;
+}
+
+/** Loads without dependencies. */
+vector<Record>
+independentTrace(size_t n, Tick delay, unsigned weight)
+{
+    vector<Record> records(n);
+    for (size_t i = 0; i < n; ++i) {
+        records[i].load = true;
+        records[i].compDelay = delay;
+        records[i].weight = weight;
+    }
+    return records;
+}
+
+/** Loads and stores with random dependencies on recent records. */
+vector<Record>
+randomTrace(size_t n, unsigned max_distance)
+{
+    vector<Record> records(n);
+    for (size_t i = 0; i < n; ++i) {
+        Record &r = records[i];
+        r.load = random_mt.random<unsigned>(0, 3) != 0;
+        unsigned num_deps = min<size_t>(i, random_mt.random<unsigned>(0, 3));
+        for (unsigned d = 0; d < num_deps; ++d) {
+            uint64_t distance = random_mt.random<uint64_t>(
+                1, min<size_t>(i, max_distance));
+            r.deps.push_back(distance);
+        }
+        r.compDelay = random_mt.random<Tick>(0, 500);
+        r.weight = random_mt.random<unsigned>(1, 4);
+    }
+    return records;
+}
+
+} // anonymous namespace
+
+int
+main()
+{
+    setClockFrequency(ULL(1000000000000));
+    curEventQueue(getEventQueue(0));
+
+    setCase("dependent loads");
+    vector<Record> chain = chainTrace(1000, 50);
+    EXPECT_TRUE(replayMatches(chain, 64, 100));
+    EXPECT_TRUE(replayMatches(chain, 64, 1000));
+
+    // the chain is latency bound, every load waits for the one before
+    writeTrace(chain, 64);
+    vector<Tick> issued = replay(chain.size(), 0, 1000);
+    unlink(traceFile);
+    EXPECT_EQ(issued.back(), 50 + 999 * (1000 + 50));
+
+    setCase("independent loads");
+    vector<Record> independent = independentTrace(1000, 10, 1);
+    EXPECT_TRUE(replayMatches(independent, 40, 100));
+    EXPECT_TRUE(replayMatches(independent, 40, 1000));
+    EXPECT_TRUE(replayMatches(independent, 400, 1000));
+    EXPECT_TRUE(replayMatches(independentTrace(1000, 10, 3), 40, 1000));
+
+    setCase("random dependencies");
+    for (int i = 0; i < 20; ++i) {
+        vector<Record> records = randomTrace(2000, 16);
+        EXPECT_TRUE(replayMatches(records, 32, 300));
+        EXPECT_TRUE(replayMatches(records, 256, 300));
+    }
+
+    setCase("dependencies beyond the window");
+    for (int i = 0; i < 5; ++i)
+        EXPECT_TRUE(replayMatches(randomTrace(2000, 100), 16, 300));
+
+    return UnitTest::printResults();
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file Checks that EventQueue dispatches events in (when, priority,
+ * last-in-first-out) order under random schedule, deschedule and
+ * service sequences, comparing against a simple reference model.  Run
+ * it with and without USE_CALENDAR_EVENTQ to cover both the bin list
+ * and the calendar queue.
+ */
+
+#include <cstdlib>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "base/types.hh"
+#include "sim/eventq_impl.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+using UnitTest::setCase;
+
+namespace {
+
+vector<int> serviced;
+
+class TestEvent : public Event
+{
+  public:
+    int id;
+
+    TestEvent(int _id, Priority pri) : Event(pri), id(_id) {}
+
+    void process() { serviced.push_back(id); }
+};
+
+typedef pair<Tick, int> Key;
+
+/**
+ * The reference queue: a stack of event ids per (when, priority), so the
+ * most recently scheduled event of a bin is serviced first.
+ */
+typedef map<Key, vector<int> > RefQueue;
+
+void
+refRemove(RefQueue &ref, const TestEvent *e)
+{
+    Key key(e->when(), e->priority());
+    vector<int> &bin = ref[key];
+    for (size_t i = 0; i < bin.size(); ++i) {
+        if (bin[i] == e->id) {
+            bin.erase(bin.begin() + i);
+            break;
+        }
+    }
+    if (bin.empty())
+        ref.erase(key);
+}
+
+/**
+ * Run a random mix of operations against the queue and the reference.
+ * Near and far times exercise bins in the current calendar year and
+ * beyond it, and a few events at MaxTick stay pending throughout.
+ */
+void
+randomOps(int num_events, int steps, Tick near, Tick far)
+{
+    EventQueue q("test queue");
+    curEventQueue(&q);
+    serviced.clear();
+
+    vector<TestEvent *> events;
+    for (int i = 0; i < num_events; ++i)
+        events.push_back(new TestEvent(i, (rand() % 3) - 1));
+
+    RefQueue ref;
+    vector<int> expected;
+    bool verified = true;
+    bool ticks_match = true;
+
+    for (int step = 0; step < steps; ++step) {
+        int op = rand() % 10;
+        TestEvent *e = events[rand() % num_events];
+        Tick now = q.getCurTick();
+
+        if (op < 5) {
+            if (!e->scheduled()) {
+                Tick when = now + (rand() % 4 ? rand() % near : rand() % far);
+                if (rand() % 1000 == 0)
+                    when = MaxTick - 1;
+                q.schedule(e, when);
+                ref[Key(when, e->priority())].push_back(e->id);
+            }
+        } else if (op < 7) {
+            if (e->scheduled()) {
+                refRemove(ref, e);
+                q.deschedule(e);
+            }
+        } else if (!q.empty() && q.nextTick() < MaxTick - 1) {
+            RefQueue::iterator head = ref.begin();
+            ticks_match &= (head->first.first == q.nextTick());
+            expected.push_back(head->second.back());
+            head->second.pop_back();
+            if (head->second.empty())
+                ref.erase(head);
+            q.serviceOne();
+        }
+
+        if (step % 997 == 0)
+            verified &= q.debugVerify();
+    }
+
+    EXPECT_TRUE(verified);
+    EXPECT_TRUE(ticks_match);
+    EXPECT_TRUE(serviced == expected);
+
+    // Taking the head and putting it back must keep every pending event
+    Event *head = q.replaceHead(NULL);
+    EXPECT_TRUE(q.empty());
+    q.replaceHead(head);
+    EXPECT_TRUE(q.debugVerify());
+
+    // Drain what is left, which must come out in reference order
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (events[i]->scheduled() && events[i]->when() == MaxTick - 1) {
+            refRemove(ref, events[i]);
+            q.deschedule(events[i]);
+        }
+    }
+    serviced.clear();
+    expected.clear();
+    while (!ref.empty()) {
+        RefQueue::iterator head = ref.begin();
+        expected.push_back(head->second.back());
+        head->second.pop_back();
+        if (head->second.empty())
+            ref.erase(head);
+        q.serviceOne();
+    }
+    EXPECT_TRUE(q.empty());
+    EXPECT_TRUE(serviced == expected);
+
+    for (size_t i = 0; i < events.size(); ++i)
+        delete events[i];
+}
+
+} // anonymous namespace
+
+int
+main()
+{
+    srand(1);
+
+    setCase("few events, close together");
+    randomOps(50, 100000, 20, 200);
+
+    setCase("many events, close together");
+    randomOps(3000, 400000, 500, 5000);
+
+    setCase("many events, widely spread");
+    randomOps(3000, 400000, 500, 1000000);
+
+    setCase("sparse events over a long span");
+    randomOps(10000, 400000, 100000, 100000000);
+
+    return UnitTest::printResults();
+}
@@ -0,0 +1,664 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file Checks the packed tag store by driving it the way Cache does on
+ * hits and misses, and comparing it against simple models of what it
+ * should hold.
+ */
+
+#include <cstring>
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "base/random.hh"
+#include "base/types.hh"
+#include "mem/cache/replacement/lfu.hh"
+#include "mem/cache/replacement/lru.hh"
+#include "mem/cache/replacement/random.hh"
+#include "mem/cache/replacement/rrip.hh"
+#include "mem/cache/replacement/tree_plru.hh"
+#include "mem/cache/tags/bdi.hh"
+#include "mem/cache/tags/packed_tags.hh"
+#include "mem/cache/base.hh"
+#include "params/BaseCache.hh"
+#include "params/LFUReplacement.hh"
+#include "params/LRUReplacement.hh"
+#include "params/PackedTags.hh"
+#include "params/RRIPReplacement.hh"
+#include "params/RandomReplacement.hh"
+#include "params/SrcClockDomain.hh"
+#include "params/System.hh"
+#include "params/TreePLRUReplacement.hh"
+#include "params/VoltageDomain.hh"
+#include "sim/clock_domain.hh"
+#include "sim/eventq.hh"
+#include "sim/system.hh"
+#include "sim/voltage_domain.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+using UnitTest::setCase;
+
+namespace {
+
+const unsigned blkSize = 64;
+
+System *testSystem = NULL;
+SrcClockDomain *testClock = NULL;
+MasterID testMaster;
+
+/**
+ * Create the objects every cache needs, a clock domain and a system
+ * without memories.
+ */
+void
+createSystem()
+{
+    VoltageDomainParams *vp = new VoltageDomainParams;
+    vp->name = "voltage_domain";
+    vp->eventq_index = 0;
+    vp->voltage = 1.0;
+
+    SrcClockDomainParams *cp = new SrcClockDomainParams;
+    cp->name = "clk_domain";
+    cp->eventq_index = 0;
+    cp->clock = 1000;
+    cp->voltage_domain = vp->create();
+    testClock = cp->create();
+
+    SystemParams *sp = new SystemParams;
+    sp->name = "system";
+    sp->eventq_index = 0;
+    sp->clk_domain = testClock;
+    sp->mem_mode = Enums::atomic;
+    sp->mem_checkpoint_format = Enums::gzip;
+    sp->mem_checkpoint_base = "";
+    sp->mem_checkpoint_lazy = false;
+    sp->cache_line_size = blkSize;
+    sp->work_item_id = -1;
+    sp->num_work_ids = 16;
+    sp->work_begin_cpu_id_exit = -1;
+    sp->work_begin_ckpt_count = 0;
+    sp->work_begin_exit_count = 0;
+    sp->work_end_ckpt_count = 0;
+    sp->work_end_exit_count = 0;
+    sp->work_cpus_ckpt_count = 0;
+    sp->init_param = 0;
+    sp->boot_osflags = "a";
+    sp->load_addr_mask = ULL(0xffffffffff);
+    testSystem = sp->create();
+
+    testMaster = testSystem->getMasterId("tester");
+}
+
+/** The replacement policies, as named by createPolicy(). */
+const char *policies[] = {
+    "LRU", "TreePLRU", "Random", "LFU", "SRRIP", "BRRIP", "DRRIP"
+};
+const unsigned numPolicies = sizeof(policies) / sizeof(policies[0]);
+
+/**
+ * Create a replacement policy with its default parameters.
+ */
+BaseReplacementPolicy *
+createPolicy(const string &kind)
+{
+    static int count = 0;
+    string name = csprintf("policy%d", count++);
+
+    if (kind == "LRU") {
+        LRUReplacementParams *p = new LRUReplacementParams;
+        p->name = name;
+        p->eventq_index = 0;
+        return p->create();
+    } else if (kind == "TreePLRU") {
+        TreePLRUReplacementParams *p = new TreePLRUReplacementParams;
+        p->name = name;
+        p->eventq_index = 0;
+        return p->create();
+    } else if (kind == "Random") {
+        RandomReplacementParams *p = new RandomReplacementParams;
+        p->name = name;
+        p->eventq_index = 0;
+        return p->create();
+    } else if (kind == "LFU") {
+        LFUReplacementParams *p = new LFUReplacementParams;
+        p->name = name;
+        p->eventq_index = 0;
+        return p->create();
+    }
+
+    RRIPReplacementParams *p = new RRIPReplacementParams;
+    p->name = name;
+    p->eventq_index = 0;
+    p->rrpv_bits = 2;
+    p->bimodal_throttle = 32;
+    p->leader_sets = 32;
+    p->psel_bits = 10;
+    if (kind == "SRRIP")
+        p->insertion = Enums::SRRIP;
+    else if (kind == "BRRIP")
+        p->insertion = Enums::BRRIP;
+    else
+        p->insertion = Enums::DRRIP;
+    return p->create();
+}
+
+/**
+ * A packed tag store inside a cache, accessed like the cache does, with
+ * the set of blocks it should hold.
+ */
+class TagStore
+{
+  public:
+    PackedTags *tags;
+    /** The block addresses the tag store should hold. */
+    set<Addr> contents;
+    /** The blocks evicted besides the victim of a miss. */
+    unsigned extraEvictions;
+
+    TagStore(unsigned size, unsigned assoc, BaseReplacementPolicy *policy,
+             unsigned sectors = 1, bool compression = false);
+
+    /**
+     * Access a block, filling it on a miss.
+     * @param data The data to fill the block with, NULL if it does not
+     * matter.
+     * @return True on a hit.
+     */
+    bool access(Addr addr, const uint8_t *data = NULL);
+
+    /**
+     * Check that the tag store holds exactly the expected blocks, and
+     * that every one of them is found by its address.
+     */
+    bool consistent();
+
+  private:
+    /** Drop a block that the cache would evict. */
+    void evict(CacheBlk *blk);
+};
+
+TagStore::TagStore(unsigned size, unsigned assoc,
+                   BaseReplacementPolicy *policy, unsigned sectors,
+                   bool compression)
+    : extraEvictions(0)
+{
+    static int count = 0;
+    string name = csprintf("cache%d", count++);
+
+    PackedTagsParams *tp = new PackedTagsParams;
+    tp->name = name + ".tags";
+    tp->eventq_index = 0;
+    tp->clk_domain = testClock;
+    tp->size = size;
+    tp->block_size = blkSize;
+    tp->hit_latency = Cycles(2);
+    tp->assoc = assoc;
+    tp->replacement_policy = policy;
+    tp->sectors = sectors;
+    tp->compression = compression;
+    tags = tp->create();
+
+    BaseCacheParams *cp = new BaseCacheParams;
+    cp->name = name;
+    cp->eventq_index = 0;
+    cp->clk_domain = testClock;
+    cp->assoc = assoc;
+    cp->size = size;
+    cp->hit_latency = Cycles(2);
+    cp->response_latency = Cycles(2);
+    cp->max_miss_count = 0;
+    cp->mshrs = 4;
+    cp->tgts_per_mshr = 8;
+    cp->write_buffers = 8;
+    cp->forward_snoops = true;
+    cp->is_top_level = false;
+    cp->two_queue = false;
+    cp->prefetch_on_access = false;
+    cp->prefetcher = NULL;
+    cp->addr_ranges.push_back(AddrRange(0, MaxAddr));
+    cp->system = testSystem;
+    cp->tags = tags;
+    cp->warm_next = NULL;
+    // the cache hands itself to the tag store
+    cp->create();
+
+    tags->regStats();
+}
+
+void
+TagStore::evict(CacheBlk *blk)
+{
+    contents.erase(tags->regenerateBlkAddr(blk->tag, blk->set));
+}
+
+bool
+TagStore::access(Addr addr, const uint8_t *data)
+{
+    Cycles lat;
+    if (tags->accessBlock(addr, lat, testMaster))
+        return true;
+
+    PacketList writebacks;
+    CacheBlk *blk = tags->findVictim(addr, writebacks);
+
+    PackedTags::BlkList extra;
+    tags->findExtraVictims(blk, addr, data, extra);
+    for (PackedTags::BlkList::iterator i = extra.begin(); i != extra.end();
+         ++i) {
+        evict(*i);
+        tags->invalidate(*i);
+        (*i)->invalidate();
+        ++extraEvictions;
+    }
+
+    if (blk->isValid())
+        evict(blk);
+    tags->insertBlock(addr, testMaster, blk);
+    blk->status = BlkValid | BlkReadable;
+    if (data) {
+        memcpy(blk->data, data, blkSize);
+        tags->dataWritten(blk);
+    }
+    contents.insert(addr);
+
+    return false;
+}
+
+/** Count the valid blocks and check that they are expected and found. */
+struct CheckBlocks
+{
+    TagStore &store;
+    unsigned valid;
+    bool ok;
+
+    CheckBlocks(TagStore &_store) : store(_store), valid(0), ok(true) {}
+
+    bool
+    operator()(CacheBlk &blk)
+    {
+        if (blk.isValid()) {
+            Addr addr = store.tags->regenerateBlkAddr(blk.tag, blk.set);
+            ok &= store.contents.count(addr) == 1;
+            ok &= store.tags->findBlock(addr) == &blk;
+            ++valid;
+        }
+        return true;
+    }
+};
+
+bool
+TagStore::consistent()
+{
+    CheckBlocks check(*this);
+    tags->forEachBlk(check);
+    return check.ok && check.valid == contents.size();
+}
+
+/**
+ * A reference LRU cache, a list of block addresses per set with the
+ * most recently used first.
+ */
+class ReferenceLRU
+{
+  private:
+    unsigned assoc;
+    vector<list<Addr> > sets;
+
+  public:
+    ReferenceLRU(unsigned num_sets, unsigned _assoc)
+        : assoc(_assoc), sets(num_sets)
+    {}
+
+    /** Access a block, returning true on a hit. */
+    bool
+    access(unsigned set, Addr addr)
+    {
+        list<Addr> &blocks = sets[set];
+        for (list<Addr>::iterator i = blocks.begin(); i != blocks.end();
+             ++i) {
+            if (*i == addr) {
+                blocks.erase(i);
+                blocks.push_front(addr);
+                return true;
+            }
+        }
+        if (blocks.size() == assoc)
+            blocks.pop_back();
+        blocks.push_front(addr);
+        return false;
+    }
+};
+
+/** A random block address, mostly from a hot region at the bottom. */
+Addr
+randomBlock(Addr footprint)
+{
+    Addr range = random_mt.random<unsigned>(0, 3) ? footprint / 4 : footprint;
+    return random_mt.random<Addr>(0, range - 1) & ~Addr(blkSize - 1);
+}
+
+/**
+ * Compare hits and misses of a tag store to the reference LRU, for
+ * random accesses over twice the cache capacity.
+ */
+bool
+matchesReferenceLRU(const string &policy, unsigned num_sets, unsigned assoc,
+                    int num_accesses)
+{
+    unsigned size = num_sets * assoc * blkSize;
+    TagStore store(size, assoc, createPolicy(policy));
+    ReferenceLRU ref(num_sets, assoc);
+
+    bool same = true;
+    for (int i = 0; i < num_accesses; ++i) {
+        Addr addr = randomBlock(2 * size);
+        bool hit = store.access(addr);
+        same &= hit == ref.access(store.tags->extractSet(addr), addr);
+        if (i % 1000 == 0)
+            same &= store.consistent();
+    }
+    return same && store.consistent();
+}
+
+/**
+ * Check that a tag store with any policy holds what it should under
+ * random accesses, and that it keeps a working set that fits.
+ */
+bool
+holdsBlocks(const string &policy, unsigned num_sets, unsigned assoc,
+            int num_accesses)
+{
+    unsigned size = num_sets * assoc * blkSize;
+    TagStore store(size, assoc, createPolicy(policy));
+
+    // every set of the empty store gets exactly assoc blocks, so after
+    // the first pass they stay, whatever the policy
+    unsigned misses = 0;
+    for (int pass = 0; pass < 3; ++pass) {
+        for (Addr addr = 0; addr < size; addr += blkSize) {
+            bool hit = store.access(addr);
+            misses += pass > 0 && !hit;
+        }
+    }
+
+    bool ok = misses == 0;
+    for (int i = 0; i < num_accesses; ++i) {
+        store.access(randomBlock(2 * size));
+        if (i % 1000 == 0)
+            ok &= store.consistent();
+    }
+    return ok && store.consistent();
+}
+
+/**
+ * Check that a policy only picks victims among the candidate ways, as
+ * the compressed tag store relies on when it evicts several blocks.
+ */
+bool
+victimsAreCandidates(const string &policy, unsigned assoc)
+{
+    const unsigned num_sets = 8;
+    BaseReplacementPolicy *repl = createPolicy(policy);
+    repl->setGeometry(num_sets, assoc);
+
+    for (unsigned set = 0; set < num_sets; ++set)
+        for (unsigned way = 0; way < assoc; ++way)
+            repl->insert(set, way);
+
+    bool ok = true;
+    for (int i = 0; i < 10000; ++i) {
+        unsigned set = random_mt.random<unsigned>(0, num_sets - 1);
+        unsigned way = random_mt.random<unsigned>(0, assoc - 1);
+        switch (random_mt.random<unsigned>(0, 3)) {
+          case 0:
+            repl->touch(set, way);
+            break;
+          case 1:
+            repl->invalidate(set, way);
+            repl->insert(set, way);
+            break;
+          default:
+            uint64_t candidates =
+                random_mt.random<uint64_t>() & mask(assoc);
+            if (!candidates)
+                candidates = ULL(1) << way;
+            unsigned victim = repl->victim(set, candidates);
+            ok &= victim < assoc && (candidates >> victim) & 1;
+            break;
+        }
+    }
+    return ok;
+}
+
+/**
+ * Check that LFU keeps a frequently used block while a stream of blocks
+ * passes through its set.
+ */
+bool
+lfuKeepsHotBlock()
+{
+    const unsigned num_sets = 16;
+    const unsigned assoc = 4;
+    const Addr set_stride = num_sets * blkSize;
+    TagStore store(num_sets * assoc * blkSize, assoc, createPolicy("LFU"));
+
+    Addr hot = 0;
+    for (int i = 0; i < 10; ++i)
+        store.access(hot);
+    for (int i = 1; i <= 100; ++i)
+        store.access(i * set_stride);
+    return store.access(hot) && store.consistent();
+}
+
+/**
+ * Check that block addresses survive the split into tag and set and
+ * back, for sectored and compressed tag stores.  Compression does not
+ * support sectors.
+ */
+bool
+tagsRoundTrip(unsigned sectors, bool compression)
+{
+    const unsigned num_sets = 64;
+    const unsigned assoc = 8;
+    TagStore store(num_sets * assoc * blkSize, assoc, createPolicy("LRU"),
+                   sectors, compression);
+    PackedTags *tags = store.tags;
+
+    bool ok = true;
+    for (int i = 0; i < 10000; ++i) {
+        Addr addr = random_mt.random<Addr>(0, ULL(1) << 48);
+        Addr blk_addr = tags->blkAlign(addr);
+        int set = tags->extractSet(addr);
+        ok &= set >= 0 && set < num_sets;
+        ok &= tags->extractBlkOffset(addr) == addr - blk_addr;
+        ok &= tags->regenerateBlkAddr(tags->extractTag(addr), set) ==
+            blk_addr;
+    }
+
+    // the blocks of a sector share a set
+    Addr sector_base = ULL(0x123450000);
+    for (unsigned i = 1; i < sectors; ++i) {
+        ok &= tags->extractSet(sector_base + i * blkSize) ==
+            tags->extractSet(sector_base);
+    }
+    return ok;
+}
+
+/**
+ * Fill the data of a block, either random or a block of zeros holding
+ * only its address, which compresses to a few bytes.
+ */
+void
+blockData(uint8_t *data, Addr addr, bool compressible)
+{
+    for (unsigned i = 0; i < blkSize; ++i)
+        data[i] = compressible ? 0 : random_mt.random<unsigned>(0, 255);
+    if (compressible)
+        memcpy(data, &addr, sizeof(addr));
+}
+
+/**
+ * Check a sectored tag store: a stream that fits misses once per block,
+ * and random accesses evict whole sectors while the store holds what
+ * it should.
+ */
+bool
+sectorsHoldBlocks(unsigned sectors)
+{
+    const unsigned num_sets = 64;
+    const unsigned assoc = 8;
+    unsigned size = num_sets * assoc * blkSize;
+    TagStore store(size, assoc, createPolicy("LRU"), sectors);
+
+    unsigned misses = 0;
+    for (int pass = 0; pass < 3; ++pass)
+        for (Addr addr = 0; addr < size * 3 / 4; addr += blkSize)
+            misses += !store.access(addr);
+    bool ok = misses == size * 3 / 4 / blkSize;
+
+    for (int i = 0; i < 100000; ++i) {
+        store.access(randomBlock(4 * size));
+        if (i % 1000 == 0)
+            ok &= store.consistent();
+    }
+    ok &= (store.extraEvictions != 0) == (sectors > 1);
+    return ok && store.consistent();
+}
+
+/**
+ * Check a compressed tag store: compressible blocks take up to twice
+ * the uncompressed capacity, incompressible ones do not, and mixed data
+ * keeps the store consistent.
+ */
+bool
+compressionHoldsBlocks()
+{
+    const unsigned num_sets = 64;
+    const unsigned assoc = 8;
+    unsigned size = num_sets * assoc * blkSize;
+    uint8_t data[blkSize];
+    bool ok = true;
+
+    for (int compressible = 0; compressible < 2; ++compressible) {
+        TagStore store(size, assoc, createPolicy("LRU"), 1, true);
+        for (int pass = 0; pass < 2; ++pass) {
+            for (Addr addr = 0; addr < size * 3 / 2; addr += blkSize) {
+                blockData(data, addr, compressible);
+                store.access(addr, data);
+            }
+        }
+        ok &= store.contents.size() ==
+            (compressible ? size * 3 / 2 : size) / blkSize;
+        ok &= store.consistent();
+
+        for (int i = 0; i < 100000; ++i) {
+            Addr addr = randomBlock(4 * size);
+            blockData(data, addr, random_mt.random<unsigned>(0, 1));
+            store.access(addr, data);
+            if (i % 1000 == 0)
+                ok &= store.consistent();
+        }
+        ok &= store.consistent();
+    }
+    return ok;
+}
+
+} // anonymous namespace
+
+int
+main()
+{
+    curEventQueue(getEventQueue(0));
+    createSystem();
+
+    // associativities that do and do not fill whole SIMD vectors
+    const unsigned assocs[] = { 1, 2, 3, 4, 5, 8, 12, 16, 64 };
+    const unsigned num_assocs = sizeof(assocs) / sizeof(assocs[0]);
+
+    setCase("LRU against a reference LRU");
+    for (unsigned i = 0; i < num_assocs; ++i)
+        EXPECT_TRUE(matchesReferenceLRU("LRU", 16, assocs[i], 50000));
+
+    setCase("two way tree PLRU against a reference LRU");
+    EXPECT_TRUE(matchesReferenceLRU("TreePLRU", 16, 2, 50000));
+
+    // tree PLRU needs a power of two associativity
+    const unsigned pow2_assocs[] = { 2, 4, 8, 16, 64 };
+    const unsigned num_pow2_assocs =
+        sizeof(pow2_assocs) / sizeof(pow2_assocs[0]);
+
+    setCase("replacement policies hold the expected blocks");
+    for (unsigned i = 0; i < numPolicies; ++i)
+        for (unsigned j = 0; j < num_pow2_assocs; ++j)
+            EXPECT_TRUE(holdsBlocks(policies[i], 16, pow2_assocs[j], 20000));
+
+    setCase("replacement policies pick victims among the candidates");
+    for (unsigned i = 0; i < numPolicies; ++i)
+        for (unsigned j = 0; j < num_pow2_assocs; ++j)
+            EXPECT_TRUE(victimsAreCandidates(policies[i], pow2_assocs[j]));
+
+    setCase("LFU keeps a frequently used block");
+    EXPECT_TRUE(lfuKeepsHotBlock());
+
+    setCase("tag and address round trip");
+    for (unsigned sectors = 1; sectors <= 8; sectors *= 2)
+        EXPECT_TRUE(tagsRoundTrip(sectors, false));
+    EXPECT_TRUE(tagsRoundTrip(1, true));
+
+    setCase("sectored tag stores");
+    for (unsigned sectors = 1; sectors <= 8; sectors *= 2)
+        EXPECT_TRUE(sectorsHoldBlocks(sectors));
+
+    setCase("compressed tag stores");
+    EXPECT_TRUE(compressionHoldsBlocks());
+
+    setCase("BDI compressed sizes");
+    uint8_t block[blkSize];
+    memset(block, 0, blkSize);
+    EXPECT_EQ(BDI::compressedSize(block, blkSize), 1);
+    for (unsigned i = 0; i < blkSize; i += 8)
+        memcpy(block + i, "repeated", 8);
+    EXPECT_EQ(BDI::compressedSize(block, blkSize), 8);
+    // pointers 8 bytes apart: an 8-byte base, 1-byte deltas and a bit each
+    for (unsigned i = 0; i < blkSize; i += 8) {
+        uint64_t pointer = ULL(0x7fff12340000) + i;
+        memcpy(block + i, &pointer, 8);
+    }
+    EXPECT_EQ(BDI::compressedSize(block, blkSize), 8 + 8 + 1);
+    for (unsigned i = 0; i < blkSize; ++i)
+        block[i] = random_mt.random<unsigned>(0, 255);
+    EXPECT_EQ(BDI::compressedSize(block, blkSize), blkSize);
+
+    return UnitTest::printResults();
+}
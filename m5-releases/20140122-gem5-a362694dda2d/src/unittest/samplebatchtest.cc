@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2014 The Regents of The University of Michigan
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file Checks that the buffered sampling of DistStor and HistStor gives
+ * the same results as folding in every sample as it arrives, across
+ * histogram rescales and resets.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+using namespace Stats;
+using UnitTest::setCase;
+
+namespace {
+
+// base/types.hh has a Counter of its own
+using Stats::Counter;
+
+/** A stand in for the stat that owns the storage. */
+struct TestInfo : public DistInfo
+{
+    bool check() const { return true; }
+    void prepare() {}
+    void reset() {}
+    bool zero() const { return true; }
+    void visit(Output &visitor) {}
+};
+
+/** Equality that also holds for two NaNs, e.g. logs of negative values. */
+bool
+same(Counter a, Counter b)
+{
+    return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+bool
+sameData(const DistData &a, const DistData &b)
+{
+    return a.type == b.type && a.min == b.min && a.max == b.max &&
+        a.bucket_size == b.bucket_size && a.min_val == b.min_val &&
+        a.max_val == b.max_val && a.underflow == b.underflow &&
+        a.overflow == b.overflow && a.cvec == b.cvec && a.sum == b.sum &&
+        a.squares == b.squares && same(a.logs, b.logs) &&
+        a.samples == b.samples;
+}
+
+DistData
+emptyData()
+{
+    DistData data;
+    data.min = data.max = data.bucket_size = Counter();
+    data.min_val = data.max_val = Counter();
+    data.underflow = data.overflow = Counter();
+    data.sum = data.squares = data.logs = data.samples = Counter();
+    return data;
+}
+
+/** A random value, occasionally far from the usual range. */
+Counter
+randomValue(Counter spread, bool negative)
+{
+    Counter val = (rand() % 4096) * spread / 4096;
+    if (rand() % 100 == 0)
+        val *= 1000;
+    if (negative && rand() % 2)
+        val = -val;
+    return val;
+}
+
+/**
+ * Sample the same values into two stores of the same stat, preparing one
+ * of them after every sample so nothing stays buffered.  Both are reset
+ * together every reset_every samples.
+ */
+template <class Stor>
+bool
+batchedMatchesDirect(Info *info, int num_samples, int reset_every,
+                     Counter spread, bool negative)
+{
+    Stor batched(info);
+    Stor direct(info);
+    DistData batched_data = emptyData();
+    DistData direct_data = emptyData();
+    bool same = true;
+
+    for (int i = 0; i < num_samples; ++i) {
+        Counter val = randomValue(spread, negative);
+        int number = 1 + rand() % 3;
+        batched.sample(val, number);
+        direct.sample(val, number);
+        direct.prepare(info, direct_data);
+
+        if (rand() % 97 == 0) {
+            batched.prepare(info, batched_data);
+            same &= sameData(batched_data, direct_data);
+        }
+
+        if (i % reset_every == reset_every - 1) {
+            batched.reset(info);
+            direct.reset(info);
+        }
+    }
+
+    batched.prepare(info, batched_data);
+    direct.prepare(info, direct_data);
+    return same && sameData(batched_data, direct_data);
+}
+
+/**
+ * Sample values into a distribution and into a straightforward model of
+ * its buckets, and compare the two.
+ */
+bool
+distMatchesReference(TestInfo &info, int num_samples)
+{
+    const DistStor::Params *params =
+        safe_cast<const DistStor::Params *>(info.storageParams);
+    DistStor stor(&info);
+
+    DistData expected = emptyData();
+    expected.cvec.resize(params->buckets);
+    expected.min_val = CounterLimits::max();
+    expected.max_val = CounterLimits::min();
+
+    for (int i = 0; i < num_samples; ++i) {
+        Counter val = params->min - 20 +
+            rand() % (int)(params->max - params->min + 40);
+        int number = 1 + rand() % 3;
+        stor.sample(val, number);
+
+        if (val < params->min) {
+            expected.underflow += number;
+        } else if (val > params->max) {
+            expected.overflow += number;
+        } else {
+            size_type index = (size_type)floor((val - params->min) /
+                                               params->bucket_size);
+            expected.cvec[index] += number;
+        }
+        expected.min_val = min(val, expected.min_val);
+        expected.max_val = max(val, expected.max_val);
+        expected.sum += val * number;
+        expected.squares += val * val * number;
+        expected.samples += number;
+    }
+
+    DistData data = emptyData();
+    stor.prepare(&info, data);
+    return data.cvec == expected.cvec &&
+        data.underflow == expected.underflow &&
+        data.overflow == expected.overflow &&
+        data.min_val == expected.min_val &&
+        data.max_val == expected.max_val && data.sum == expected.sum &&
+        data.squares == expected.squares &&
+        data.samples == expected.samples;
+}
+
+} // anonymous namespace
+
+int
+main()
+{
+    srand(1);
+
+    TestInfo dist_info;
+    DistStor::Params dist_params;
+    dist_params.min = -50;
+    dist_params.max = 250;
+    dist_params.bucket_size = 10;
+    dist_params.buckets = 31;
+    dist_info.storageParams = &dist_params;
+
+    TestInfo hist_info;
+    HistStor::Params hist_params;
+    hist_params.buckets = 20;
+    hist_info.storageParams = &hist_params;
+
+    setCase("distribution against a reference");
+    EXPECT_TRUE(distMatchesReference(dist_info, 100000));
+
+    setCase("distribution, batched and direct");
+    EXPECT_TRUE(batchedMatchesDirect<DistStor>(&dist_info, 100000, 100000,
+                                               300, true));
+
+    setCase("distribution, batched and direct, with resets");
+    EXPECT_TRUE(batchedMatchesDirect<DistStor>(&dist_info, 100000, 1000,
+                                               300, true));
+
+    setCase("histogram, batched and direct, growing up");
+    EXPECT_TRUE(batchedMatchesDirect<HistStor>(&hist_info, 100000, 100000,
+                                               100, false));
+
+    setCase("histogram, batched and direct, growing out");
+    EXPECT_TRUE(batchedMatchesDirect<HistStor>(&hist_info, 100000, 100000,
+                                               100, true));
+
+    setCase("histogram, batched and direct, with resets");
+    EXPECT_TRUE(batchedMatchesDirect<HistStor>(&hist_info, 100000, 777,
+                                               1000, true));
+
+    setCase("histogram, batched and direct, few samples between resets");
+    EXPECT_TRUE(batchedMatchesDirect<HistStor>(&hist_info, 100000, 5,
+                                               1000, true));
+
+    return UnitTest::printResults();
+}
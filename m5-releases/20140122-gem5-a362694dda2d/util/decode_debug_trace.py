@@ -0,0 +1,280 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2014 The Regents of The University of Michigan
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# This script formats the binary debug trace written by gem5 when run
+# with --debug-binary into the text that --debug-file would have
+# received. The records of all threads are merged in tick order.
+#
+# The file starts with the magic "M5TRACEB" and a version byte,
+# followed by one block per thread buffer:
+#   dropped record count
+#   flag, object name and format string tables (count, then strings)
+#   byte count of the records
+#   records, each a 32-bit little-endian length followed by
+#     tick + 1 (0 for none), flag id, name id, format id (0 for a
+#     data dump), and the tagged arguments
+# Integers are LEB128 variable-length, strings are a length followed
+# by the bytes, and table ids start at 1, 0 meaning none.
+#
+# Usage: decode_debug_trace.py [--flags FLAG[,FLAG]] <trace> [<output>]
+
+import heapq
+import optparse
+import re
+import struct
+import sys
+
+magic = 'M5TRACEB'
+version = 1
+
+# argument tags from src/base/trace_buffer.hh
+Signed, Unsigned, Double, String = 0x10, 0x20, 0x30, 0x40
+
+class Reader(object):
+    def __init__(self, data, pos=0):
+        self.data = data
+        self.pos = pos
+
+    def varint(self):
+        result = 0
+        shift = 0
+        while True:
+            b = ord(self.data[self.pos])
+            self.pos += 1
+            result |= (b & 0x7f) << shift
+            if not (b & 0x80):
+                return result
+            shift += 7
+
+    def bytes(self, n):
+        s = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return s
+
+    def string(self):
+        return self.bytes(self.varint())
+
+    def table(self):
+        return [ None ] + [ self.string() for i in xrange(self.varint()) ]
+
+    def arg(self):
+        tag = ord(self.bytes(1))
+        kind, size = tag & 0xf0, tag & 0xf
+        if kind == Signed:
+            v = self.varint()
+            return (v >> 1) ^ -(v & 1), size
+        if kind == Unsigned:
+            return self.varint(), size
+        if kind == Double:
+            return struct.unpack('<d', self.bytes(8))[0], 8
+        if kind == String:
+            return self.string(), 0
+        raise IOError('Bad argument tag %#x' % tag)
+
+# %[flags][width][.precision][length]conversion, as parsed by cprintf
+spec_re = re.compile(r'%([#\-+ 0]*)(\*|\d+)?(?:\.(\*|\d*))?[lhqLzjt]*(.)')
+
+def convert(flags, width, precision, conv, value, size):
+    """Format one argument like cprintf does."""
+    if conv == 'p':
+        flags, conv = flags + '#', 'x'
+
+    if conv in 'diuxXo':
+        if isinstance(value, str):
+            return ('%' + ('-' if '-' in flags else '') +
+                    (width or '') + 's') % value
+        if isinstance(value, float):
+            value = int(value)
+        if value < 0 and conv in 'xXo' and size:
+            value &= (1 << (8 * size)) - 1
+        if precision is not None:
+            # cprintf treats an integer precision as a zero filled width
+            width, flags = precision, flags + '0'
+        if conv == 'u':
+            conv = 'd'
+        if value == 0 and '#' in flags and '0' not in flags:
+            flags = flags.replace('#', '')
+        spec = '%' + flags + (width or '') + conv
+        return spec % value
+
+    if conv in 'eEfgG':
+        if isinstance(value, str):
+            return value
+        spec = '%' + flags + (width or '')
+        if precision is not None:
+            spec += '.' + precision
+        return (spec + conv) % value
+
+    if conv == 'c':
+        if not isinstance(value, str):
+            value = chr(value & 0xff)
+        return ('%' + ('-' if '-' in flags else '') + (width or '') +
+                's') % value
+
+    if conv == 's':
+        if isinstance(value, float):
+            value = '%g' % value
+        elif not isinstance(value, str):
+            value = str(value)
+        return ('%' + ('-' if '-' in flags else '') + (width or '') +
+                's') % value
+
+    return '<bad format>'
+
+def cformat(fmt, args):
+    out = []
+    pos = 0
+    args = list(args)
+    while True:
+        i = fmt.find('%', pos)
+        if i < 0:
+            out.append(fmt[pos:])
+            break
+        out.append(fmt[pos:i])
+        if fmt[i + 1:i + 2] == '%':
+            out.append('%')
+            pos = i + 2
+            continue
+        m = spec_re.match(fmt, i)
+        if not m:
+            out.append(fmt[i:])
+            break
+        pos = m.end()
+        flags, width, precision, conv = m.groups()
+        if width == '*':
+            width = str(args.pop(0)[0]) if args else None
+        if precision == '*':
+            precision = str(args.pop(0)[0]) if args else None
+        elif precision == '':
+            precision = '0'
+        if not args:
+            out.append('<missing arg>')
+            continue
+        value, size = args.pop(0)
+        out.append(convert(flags, width, precision, conv, value, size))
+    if args:
+        out.append('<extra arg>')
+    return ''.join(out)
+
+def hexdump(prefix, data):
+    lines = []
+    for i in xrange(0, len(data), 16):
+        chunk = data[i:i + 16]
+        line = prefix + '%08x  ' % i
+        for j, c in enumerate(chunk):
+            line += '%02x ' % ord(c)
+            if j == 7:
+                line += ' '
+        line += '   ' * (16 - len(chunk)) + '  '
+        line += ''.join(c if 32 <= ord(c) < 127 else ' '
+                        for c in (chr(ord(c) & 0x7f) for c in chunk))
+        lines.append(line + '\n')
+    return ''.join(lines)
+
+def records(reader, end, flags, names, formats, index, wanted):
+    """Generate (tick, buffer index, sequence, text) for the records of
+    one buffer. Records without a tick sort with the record before."""
+    tick = 0
+    seq = 0
+    while reader.pos < end:
+        length = struct.unpack('<I', reader.bytes(4))[0]
+        rec = Reader(reader.data, reader.pos)
+        reader.pos += length
+
+        when = rec.varint()
+        flag = flags[rec.varint()]
+        name = names[rec.varint()]
+        fmt = formats[rec.varint()]
+        args = []
+        while rec.pos < reader.pos:
+            args.append(rec.arg())
+
+        if when:
+            tick = when - 1
+        seq += 1
+        if wanted and flag not in wanted:
+            continue
+
+        prefix = ''
+        if when:
+            prefix += '%7d: ' % (when - 1)
+        if name is not None:
+            prefix += '%s: ' % name
+
+        if fmt is None:
+            text = hexdump(prefix, args[0][0])
+        else:
+            text = prefix + cformat(fmt, args)
+        yield (tick, index, seq, text)
+
+def main():
+    parser = optparse.OptionParser(
+        usage="%prog [options] <binary trace> [<text output>]")
+    parser.add_option("--flags", metavar="FLAG[,FLAG]", default="",
+        help="Only print records of these debug flags")
+    (options, args) = parser.parse_args()
+    if len(args) not in (1, 2):
+        parser.error("wrong number of arguments")
+
+    try:
+        data = open(args[0], 'rb').read()
+    except IOError:
+        print "Failed to open ", args[0], " for reading"
+        exit(-1)
+
+    if data[:len(magic)] != magic or ord(data[len(magic)]) != version:
+        print "Unrecognized file"
+        exit(-1)
+
+    out = sys.stdout
+    if len(args) == 2:
+        out = open(args[1], 'w')
+
+    wanted = set(f for f in options.flags.split(',') if f)
+
+    reader = Reader(data, len(magic) + 1)
+    streams = []
+    while reader.pos < len(data):
+        dropped = reader.varint()
+        flags = reader.table()
+        names = reader.table()
+        formats = reader.table()
+        size = reader.varint()
+        if dropped:
+            print >>sys.stderr, "buffer %d: %d records were overwritten" % \
+                (len(streams), dropped)
+        buf = Reader(data, reader.pos)
+        reader.pos += size
+        streams.append(records(buf, reader.pos, flags, names, formats,
+                               len(streams), wanted))
+
+    for tick, index, seq, text in heapq.merge(*streams):
+        out.write(text)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,143 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2014 The Regents of The University of Michigan
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# This script dumps an elastic trace, captured from the O3 CPU with its
+# elastic_trace_file parameter, to ASCII. It assumes that protoc has
+# been executed and already generated the Python package for the
+# messages. This can be done manually using:
+# protoc --python_out=. --proto_path=src/proto \
+#     src/proto/inst_dep_record.proto
+#
+# The ASCII format uses one line per record on the format id, type,
+# addr, size, flags, weight, comp_delay, deps, where the dependencies
+# are the numbers of the records separated by colons. For example:
+# 0,r,128,8,0,3,500,
+# 1,w,232123,8,0,12,1000,0
+
+import gzip
+import sys
+
+# Import the proto definitions. If they are not found, attempt to
+# generate them automatically. This assumes that the script is
+# executed from the gem5 root.
+try:
+    import inst_dep_record_pb2
+except:
+    print "Did not find proto definitions, attempting to generate"
+    from subprocess import call
+    error = call(['protoc', '--python_out=util', '--proto_path=src/proto',
+                  'src/proto/inst_dep_record.proto'])
+    if not error:
+        import inst_dep_record_pb2
+        print "Generated proto definitions"
+    else:
+        print "Failed to import proto definitions"
+        exit(-1)
+
+def decodeVarint(in_file):
+    """Read a varint, or return None at the end of the file."""
+    result = 0
+    shift = 0
+    while True:
+        c = in_file.read(1)
+        if len(c) == 0:
+            return None
+        b = ord(c)
+        result |= (b & 0x7f) << shift
+        if not (b & 0x80):
+            return result
+        shift += 7
+        if shift >= 64:
+            raise IOError('Too many bytes when decoding varint.')
+
+def decodeMessage(in_file, message):
+    """
+    Attempt to read a message from the file and decode it. Return
+    False if no message could be read.
+    """
+    try:
+        size = decodeVarint(in_file)
+        if size is None:
+            return False
+        message.ParseFromString(in_file.read(size))
+        return True
+    except IOError:
+        return False
+
+def main():
+    if len(sys.argv) != 3:
+        print "Usage: ", sys.argv[0], " <protobuf input> <ASCII output>"
+        exit(-1)
+
+    try:
+        if sys.argv[1].endswith('.gz'):
+            proto_in = gzip.open(sys.argv[1], 'rb')
+        else:
+            proto_in = open(sys.argv[1], 'rb')
+    except IOError:
+        print "Failed to open ", sys.argv[1], " for reading"
+        exit(-1)
+
+    try:
+        ascii_out = open(sys.argv[2], 'w')
+    except IOError:
+        print "Failed to open ", sys.argv[2], " for writing"
+        exit(-1)
+
+    if proto_in.read(4) != "gem5":
+        print "Unrecognized file"
+        exit(-1)
+
+    header = inst_dep_record_pb2.InstDepRecordHeader()
+    decodeMessage(proto_in, header)
+
+    print "Object id:", header.obj_id
+    print "Tick frequency:", header.tick_freq
+    print "Window size:", header.window_size
+
+    num_records = 0
+    num_insts = 0
+    rec = inst_dep_record_pb2.InstDepRecord()
+    while decodeMessage(proto_in, rec):
+        t = 'r' if rec.type == inst_dep_record_pb2.InstDepRecord.LOAD \
+            else 'w'
+        deps = ':'.join(str(num_records - d) for d in rec.reg_dep)
+        ascii_out.write('%d,%s,%d,%d,%d,%d,%d,%s\n' %
+                        (num_records, t, rec.p_addr, rec.size, rec.flags,
+                         rec.weight, rec.comp_delay, deps))
+        num_records += 1
+        num_insts += rec.weight
+
+    print "Parsed records:", num_records
+    print "Instructions:", num_insts
+
+    ascii_out.close()
+    proto_in.close()
+
+if __name__ == "__main__":
+    main()
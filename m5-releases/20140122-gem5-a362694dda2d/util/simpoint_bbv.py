@@ -0,0 +1,113 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2014 The Regents of The University of Michigan
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# This script converts the binary SimPoint basic block vectors written
+# by a CPU with simpoint_binary set into the text format read by the
+# SimPoint tool, one line per interval:
+# T:id:count :id:count ...
+#
+# The binary file starts with the magic "M5SPBBV\n" followed by the
+# format version and the interval size. Every interval is the number
+# of blocks it executed followed by a (id - previous id, count) pair
+# for each block, all as LEB128 variable-length integers. Either file
+# may be gzipped, as determined by the .gz suffix.
+
+import gzip
+import sys
+
+magic = 'M5SPBBV\n'
+version = 1
+
+def openFile(name, mode):
+    if name.endswith('.gz'):
+        return gzip.open(name, mode)
+    return open(name, mode)
+
+def readVarint(f):
+    """Read a variable-length integer, None at the end of the file."""
+    result = 0
+    shift = 0
+    while True:
+        c = f.read(1)
+        if not c:
+            if shift:
+                raise IOError('Truncated varint')
+            return None
+        b = ord(c)
+        result |= (b & 0x7f) << shift
+        if not (b & 0x80):
+            return result
+        shift += 7
+
+def intervals(f):
+    """Generate the intervals of a binary BBV file as lists of
+    (id, count) pairs."""
+    if f.read(len(magic)) != magic:
+        raise IOError('Not a binary SimPoint BBV file')
+    if readVarint(f) != version:
+        raise IOError('Unsupported binary SimPoint BBV version')
+    readVarint(f) # interval size
+
+    while True:
+        n = readVarint(f)
+        if n is None:
+            return
+        bbv = []
+        last = 0
+        for i in xrange(n):
+            last += readVarint(f)
+            bbv.append((last, readVarint(f)))
+        yield bbv
+
+def main():
+    if len(sys.argv) != 3:
+        print "Usage: ", sys.argv[0], " <binary BBV input> <text output>"
+        exit(-1)
+
+    try:
+        bbv_in = openFile(sys.argv[1], 'rb')
+    except IOError:
+        print "Failed to open ", sys.argv[1], " for reading"
+        exit(-1)
+
+    try:
+        text_out = openFile(sys.argv[2], 'w')
+    except IOError:
+        print "Failed to open ", sys.argv[2], " for writing"
+        exit(-1)
+
+    for bbv in intervals(bbv_in):
+        text_out.write('T')
+        for id, count in bbv:
+            text_out.write(':%d:%d ' % (id, count))
+        text_out.write('\n')
+
+    text_out.close()
+
+if __name__ == "__main__":
+    main()
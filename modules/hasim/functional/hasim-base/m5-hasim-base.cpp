@@ -37,9 +37,12 @@
 
 #include <signal.h>
 #include <sys/types.h>
-#include <sys/stat.h>
+#include <dirent.h>
 #include <unistd.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
 
 #include <Python.h>
 
@@ -51,13 +54,22 @@
 
 // m5
 #include "sim/init.hh"
+#include "sim/process.hh"
 #include "sim/sim_object.hh"
 extern SimObject *resolveSimObject(const string &);
+extern std::mutex *HAsimMemoryMutex;
 
 std::mutex M5_HASIM_BASE_CLASS::m5mutex;
 ATOMIC32_CLASS M5_HASIM_BASE_CLASS::refCnt;
 AtomicSimpleCPU_PTR *M5_HASIM_BASE_CLASS::m5cpus;
 UINT32 M5_HASIM_BASE_CLASS::numCPUs;
+bool M5_HASIM_BASE_CLASS::parallelContexts = false;
+bool M5_HASIM_BASE_CLASS::reportCounters = false;
+std::mutex *M5_HASIM_BASE_CLASS::ctxMutex = NULL;
+std::mutex **M5_HASIM_BASE_CLASS::ctxLock = NULL;
+std::mutex M5_HASIM_BASE_CLASS::memMutex;
+std::atomic<UINT64> M5_HASIM_BASE_CLASS::lockAcquires(0);
+std::atomic<UINT64> M5_HASIM_BASE_CLASS::lockContended(0);
 
 
 void
@@ -67,6 +79,57 @@ m5HAsimExitNowHandler(int sigtype)
 }
 
 
+//
+// Seconds elapsed since start.  Updates start to now, so consecutive calls
+// time consecutive startup phases.
+//
+static double
+StartupPhaseTime(std::chrono::steady_clock::time_point &start)
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double t = std::chrono::duration<double>(now - start).count();
+    start = now;
+    return t;
+}
+
+
+//
+// Count the program.N workload directories in the current directory with
+// N < MAX_NUM_CONTEXTS.  A single directory scan replaces probing every
+// possible name.
+//
+static UINT32
+CountWorkloads()
+{
+    DIR *dir = opendir(".");
+    VERIFY(dir != NULL, "Failed to open the workload directory");
+
+    UINT32 n = 0;
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL)
+    {
+        // Accept only the canonical names:  decimal digits without a sign
+        // or leading zeros, the same names the workload setup creates.
+        const char *id_str = ent->d_name + strlen("program.");
+        if ((strncmp(ent->d_name, "program.", strlen("program.")) != 0) ||
+            (*id_str == '\0') ||
+            (strspn(id_str, "0123456789") != strlen(id_str)) ||
+            ((id_str[0] == '0') && (id_str[1] != '\0')))
+        {
+            continue;
+        }
+
+        if (strtoul(id_str, NULL, 10) < MAX_NUM_CONTEXTS)
+        {
+            n++;
+        }
+    }
+
+    closedir(dir);
+    return n;
+}
+
+
 M5_HASIM_BASE_CLASS::M5_HASIM_BASE_CLASS()
 {
     if (refCnt++ == 0)
@@ -74,6 +137,9 @@ M5_HASIM_BASE_CLASS::M5_HASIM_BASE_CLASS()
         //
         // Initialize m5
         //
+        std::chrono::steady_clock::time_point phase_start =
+            std::chrono::steady_clock::now();
+        double t_python, t_discover, t_m5main, t_cpus;
 
         // M5 expects the executable name to be in argv[0]
         // and to receive MAX_NUM_CPUS in --num-cpus
@@ -90,6 +156,7 @@ M5_HASIM_BASE_CLASS::M5_HASIM_BASE_CLASS()
 
         // Initialize the embedded m5 python library
         VERIFY(initM5Python() == 0, "Failed to initialize m5 Python");
+        t_python = StartupPhaseTime(phase_start);
 
 
         for (int i = 0; i < globalArgs->FuncPlatformArgc(); i++)
@@ -98,7 +165,6 @@ M5_HASIM_BASE_CLASS::M5_HASIM_BASE_CLASS()
         }
 
         char* cpuArg  = new char[32];
-        char* dirName = new char[32];
 
         // TEMPORARY:: For now we only load an M5 CPU for each existing
         // program.N directory. In the future this should be specified better.
@@ -108,25 +174,20 @@ M5_HASIM_BASE_CLASS::M5_HASIM_BASE_CLASS()
         // Probably the right solution in the future involves have separate setup/run
         // scripts for hasim benchmarks and generic benchmarks.
         
-        numCPUs = 0;
-        for (int i = 0; i < MAX_NUM_CONTEXTS; i++)
-        {
-            sprintf(dirName, "program.%d", i);
-            struct stat stFileInfo; 
-            int statRes = stat(dirName, &stFileInfo); 
-            bool program_exists = statRes ==0;
-            if (program_exists)
-                numCPUs++;
-        }
-        delete dirName;
-        
+        numCPUs = CountWorkloads();
+        t_discover = StartupPhaseTime(phase_start);
+
         VERIFY(numCPUs <= MAX_NUM_CONTEXTS, "Error: more programs set up than available hardware threads!");
         VERIFY(numCPUs > 0, "Error: no programs found for hardware threads.");
 
         sprintf(cpuArg, "--num-cpus=%d", numCPUs);
         new_argv[globalArgs->FuncPlatformArgc() + 1] = cpuArg;
 
+        // Identical workloads share the physical pages holding their text
+        LiveProcess::shareText = (M5_SHARE_TEXT != 0);
+
         m5Main(globalArgs->FuncPlatformArgc() + 2, new_argv);
+        t_m5main = StartupPhaseTime(phase_start);
 
         // Drop m5 handling of SIGINT and SIGABRT.  These don't work well since
         // m5's event loop isn't running.  Simply exit, hoping that some buffers
@@ -160,6 +221,59 @@ M5_HASIM_BASE_CLASS::M5_HASIM_BASE_CLASS()
                 ASSERT(m5cpus[cpu] != NULL, "Failed to find m5 cpu object: " << cpu_name);
             }
         }
+
+        //
+        // Parallel context emulation.  Each context gets a private lock
+        // for its own CPU and process.  State shared by all contexts is
+        // protected by finer grained locks:  m5 physical memory by memMutex
+        // (via HAsimMemoryMutex), physical page allocation inside m5's
+        // System::allocPhysPages() and emulated syscalls by m5mutex.
+        //
+        // Contexts sharing a process would write its page table and
+        // syscall state under different locks, so they fall back to
+        // m5mutex.
+        //
+        parallelContexts = (M5_PARALLEL_CONTEXTS != 0);
+        reportCounters = (M5_REPORT_COUNTERS != 0);
+        ctxMutex = new std::mutex[numCPUs];
+        ctxLock = new std::mutex*[numCPUs];
+
+        UINT32 nShared = 0;
+        for (int cpu = 0; cpu < numCPUs; cpu++)
+        {
+            Process *p = m5cpus[cpu]->tc->getProcessPtr();
+            bool shared = false;
+            for (int other = 0; other < numCPUs; other++)
+            {
+                if ((other != cpu) && (m5cpus[other]->tc->getProcessPtr() == p))
+                {
+                    shared = true;
+                }
+            }
+
+            ctxLock[cpu] = shared ? &m5mutex : &ctxMutex[cpu];
+            nShared += shared ? 1 : 0;
+        }
+
+        if (parallelContexts && (nShared != 0))
+        {
+            ASIMWARNING("M5_PARALLEL_CONTEXTS: " << nShared
+                        << " contexts share a process and are emulated serially"
+                        << endl);
+        }
+
+        if (parallelContexts)
+        {
+            HAsimMemoryMutex = &memMutex;
+        }
+
+        t_cpus = StartupPhaseTime(phase_start);
+
+        cout << "m5 startup (seconds): python " << t_python
+             << ", workload discovery " << t_discover
+             << ", configuration and load " << t_m5main
+             << ", CPU lookup " << t_cpus
+             << " (" << numCPUs << " contexts)" << endl;
     }
 }
 
@@ -168,7 +282,36 @@ M5_HASIM_BASE_CLASS::~M5_HASIM_BASE_CLASS()
 {
     if (refCnt-- == 1)
     {
+        if (reportCounters && (lockAcquires != 0))
+        {
+            cout << "m5 context locks: " << lockAcquires << " acquired, "
+                 << lockContended << " contended" << endl;
+        }
+
+        HAsimMemoryMutex = NULL;
+
         Py_Finalize();
         delete[] m5cpus;
+        delete[] ctxMutex;
+        delete[] ctxLock;
+    }
+}
+
+
+void
+M5_HASIM_BASE_CLASS::LockCounted(unique_lock<std::mutex> &lock)
+{
+    if (! reportCounters)
+    {
+        lock.lock();
+        return;
+    }
+
+    lockAcquires++;
+
+    if (! lock.try_lock())
+    {
+        lockContended++;
+        lock.lock();
     }
 }
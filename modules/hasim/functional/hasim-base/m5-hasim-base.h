@@ -38,6 +38,7 @@
 #ifndef __HASIM_M5_BASE__
 #define __HASIM_M5_BASE__
 
+#include <atomic>
 #include <mutex>
 
 #include "asim/syntax.h"
@@ -58,6 +59,13 @@ class M5_HASIM_BASE_CLASS
 
     UINT32 NumCPUs() const { return numCPUs; };
 
+    // True when contexts may be emulated in parallel (M5_PARALLEL_CONTEXTS).
+    static bool ParallelContexts() { return parallelContexts; };
+
+    // True when counts of m5 activity (lock contention, VtoP cache hits,
+    // memory notes) are collected and printed at exit (M5_REPORT_COUNTERS).
+    static bool ReportCounters() { return reportCounters; };
+
   protected:
     AtomicSimpleCPU *M5Cpu(UINT32 cpuId) const
     {
@@ -68,10 +76,39 @@ class M5_HASIM_BASE_CLASS
     // Calling m5 in parallel is dangerous.
     static std::mutex m5mutex;
 
+    //
+    // Lock protecting the m5 state owned by a single context:  its CPU,
+    // thread context and process (including the page table).  In parallel
+    // mode each context with a process of its own has a private lock.
+    // Contexts sharing a process (clone'd threads) and all contexts in
+    // serial mode share m5mutex.
+    //
+    std::mutex &CtxMutex(UINT32 cpuId) const
+    {
+        return parallelContexts ? *ctxLock[cpuId] : m5mutex;
+    };
+
+    // Acquire a lock, counting acquisitions that had to wait for another
+    // thread.  With M5_REPORT_COUNTERS the totals are reported when m5 is
+    // shut down.
+    static void LockCounted(std::unique_lock<std::mutex> &lock);
+
   private:
     static ATOMIC32_CLASS refCnt;
     static AtomicSimpleCPU_PTR *m5cpus;
     static UINT32 numCPUs;
+
+    static bool parallelContexts;
+    static bool reportCounters;
+    static std::mutex *ctxMutex;
+    // The lock of each context, ctxMutex or m5mutex
+    static std::mutex **ctxLock;
+
+    // Guards m5 physical memory (LL/SC state and statistics) in parallel mode
+    static std::mutex memMutex;
+
+    static std::atomic<UINT64> lockAcquires;
+    static std::atomic<UINT64> lockContended;
 };
 
 #endif //  __HASIM_M5_BASE__
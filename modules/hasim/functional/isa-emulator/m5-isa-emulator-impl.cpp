@@ -29,7 +29,11 @@
 // POSSIBILITY OF SUCH DAMAGE.
 //
  
+#include <atomic>
+#include <map>
 #include <mutex>
+#include <stdlib.h>
+#include <string.h>
 
 #include "asim/syntax.h"
 
@@ -54,14 +58,20 @@ INSTR_SPECIAL_EMULATION;
 static void *StatsUpdateThread(void *arg);
 
 // Allow only one instance of an emulator to be running in order to avoid
-// the danger of multiple threads driving Gem5.
+// the danger of multiple threads driving Gem5.  Not used when contexts are
+// emulated in parallel.  Each context is then protected by its own lock
+// (see M5_HASIM_BASE_CLASS::CtxMutex()).
 static std::mutex emulMutex;
 
 // Global Gem5 lock management is complicated by HAsimNoteMemoryRead/Write
 // because they call back to the hardware and may trigger memory operations.
-// This lock is set and cleared only after emulMutex is locked, so the
-// lock itself is shared among all users.
-static unique_lock<std::mutex> *emulGem5Lock = NULL;
+// The callbacks release the lock held by the emulating thread, so it is
+// recorded per thread.
+static __thread unique_lock<std::mutex> *emulGem5Lock = NULL;
+
+// The global lock taken for a syscall in parallel mode, also released by
+// the callbacks.
+static __thread unique_lock<std::mutex> *emulSyscallLock = NULL;
 
 
 //***********************************************************************
@@ -75,9 +85,177 @@ static unique_lock<std::mutex> *emulGem5Lock = NULL;
 extern void (*HAsimNoteMemoryRead)(Addr paddr, uint64_t size);
 extern void (*HAsimNoteMemoryWrite)(Addr paddr, uint64_t size);
 
-static bool inEmulation = false;
-static bool emulationMayRefMemory = false;
-static CONTEXT_ID emulationCtxId = 0;
+static __thread bool inEmulation = false;
+static __thread bool emulationMayRefMemory = false;
+static __thread CONTEXT_ID emulationCtxId = 0;
+
+// Counted only with M5_REPORT_COUNTERS
+static std::atomic<UINT64> memRefsNoted(0);     // Callbacks from m5
+static std::atomic<UINT64> memNotesSent(0);     // Notes sent to the hardware
+
+//
+// Memory references during one emulated instruction, tracked at
+// MEM_NOTE_LINE_BYTES granularity.  A syscall may touch the same lines
+// thousands of times (e.g. strings are read a byte at a time), so only
+// the first reference to a line is passed to the hardware:
+//
+//   - The first reference, read or write, is sent immediately since the
+//     hardware must write back dirty data before m5 uses the line.
+//     Adjacent new lines in one reference are merged into one note.
+//   - Later references to a line are dropped, except for a write to a
+//     line first seen by a read.  The hardware may still hold a clean
+//     copy of that line.  Those invalidations are deferred, merged into
+//     ranges and sent once by Flush() when the instruction completes.
+//
+class EMUL_MEM_NOTES
+{
+  public:
+    void Reference(Addr paddr, UINT64 size, bool isWrite);
+    void Flush();
+
+  private:
+    enum LINE_STATE
+    {
+        LINE_READ,
+        LINE_WRITTEN,
+        LINE_WRITE_PENDING
+    };
+
+    std::map<Addr, LINE_STATE> lines;
+
+    void Send(Addr start, Addr end, bool isWrite);
+};
+
+// Emulation is per thread, so the reference tracker is too.
+static __thread EMUL_MEM_NOTES *emulMemNotes = NULL;
+
+
+void
+EMUL_MEM_NOTES::Reference(
+    Addr paddr,
+    UINT64 size,
+    bool isWrite)
+{
+    if (M5_HASIM_BASE_CLASS::ReportCounters())
+    {
+        memRefsNoted++;
+    }
+
+    Addr first = paddr & ~Addr(MEM_NOTE_LINE_BYTES - 1);
+    Addr last = (paddr + size - 1) & ~Addr(MEM_NOTE_LINE_BYTES - 1);
+
+    // Start of a run of lines not yet seen (run_end == run_start when
+    // there is no open run).
+    Addr run_start = first;
+    Addr run_end = first;
+
+    for (Addr line = first; line <= last; line += MEM_NOTE_LINE_BYTES)
+    {
+        std::map<Addr, LINE_STATE>::iterator l = lines.find(line);
+        if (l == lines.end())
+        {
+            lines[line] = isWrite ? LINE_WRITTEN : LINE_READ;
+            if (run_end == run_start)
+            {
+                run_start = line;
+            }
+            run_end = line + MEM_NOTE_LINE_BYTES;
+            continue;
+        }
+
+        if (isWrite && (l->second == LINE_READ))
+        {
+            l->second = LINE_WRITE_PENDING;
+        }
+
+        if (run_end != run_start)
+        {
+            Send(run_start, run_end, isWrite);
+            run_start = run_end;
+        }
+    }
+
+    if (run_end != run_start)
+    {
+        Send(run_start, run_end, isWrite);
+    }
+}
+
+
+void
+EMUL_MEM_NOTES::Flush()
+{
+    Addr run_start = 0;
+    Addr run_end = 0;
+
+    for (std::map<Addr, LINE_STATE>::iterator l = lines.begin();
+         l != lines.end();
+         ++l)
+    {
+        if (l->second != LINE_WRITE_PENDING) continue;
+
+        if ((run_end != run_start) && (l->first != run_end))
+        {
+            Send(run_start, run_end, true);
+            run_start = run_end;
+        }
+
+        if (run_end == run_start)
+        {
+            run_start = l->first;
+        }
+        run_end = l->first + MEM_NOTE_LINE_BYTES;
+    }
+
+    if (run_end != run_start)
+    {
+        Send(run_start, run_end, true);
+    }
+
+    lines.clear();
+}
+
+
+//
+// Notify the hardware about [start, end).  The hardware may trigger memory
+// operations, so the thread's Gem5 lock is released during the call.
+//
+void
+EMUL_MEM_NOTES::Send(
+    Addr start,
+    Addr end,
+    bool isWrite)
+{
+    if (M5_HASIM_BASE_CLASS::ReportCounters())
+    {
+        memNotesSent++;
+    }
+
+    bool was_in_emulation = inEmulation;
+    inEmulation = false;    // Prevent loops
+    if (emulSyscallLock)
+    {
+        emulSyscallLock->unlock();
+    }
+    emulGem5Lock->unlock();
+
+    if (isWrite)
+    {
+        FUNCP_MEMORY_CLASS::NoteSystemMemoryWrite(emulationCtxId, start, end - start);
+    }
+    else
+    {
+        FUNCP_MEMORY_CLASS::NoteSystemMemoryRead(emulationCtxId, start, end - start);
+    }
+
+    emulGem5Lock->lock();
+    if (emulSyscallLock)
+    {
+        emulSyscallLock->lock();
+    }
+    inEmulation = was_in_emulation;
+}
+
 
 void
 HAsimEmulMemoryRead(Addr paddr, UINT64 size)
@@ -87,11 +265,7 @@ HAsimEmulMemoryRead(Addr paddr, UINT64 size)
         // Some emulation modes assume no memory is referenced
         VERIFY(emulationMayRefMemory, "Emulated REGOP touches memory!");
 
-        inEmulation = false;    // Prevent loops
-        emulGem5Lock->unlock();
-        FUNCP_MEMORY_CLASS::NoteSystemMemoryRead(emulationCtxId, paddr, size);
-        emulGem5Lock->lock();
-        inEmulation = true;
+        emulMemNotes->Reference(paddr, size, false);
     }
 }
 
@@ -103,11 +277,7 @@ HAsimEmulMemoryWrite(Addr paddr, UINT64 size)
         // Some emulation modes assume no memory is referenced
         VERIFY(emulationMayRefMemory, "Emulated REGOP touches memory!");
 
-        inEmulation = false;    // Prevent loops
-        emulGem5Lock->unlock();
-        FUNCP_MEMORY_CLASS::NoteSystemMemoryWrite(emulationCtxId, paddr, size);
-        emulGem5Lock->lock();
-        inEmulation = true;
+        emulMemNotes->Reference(paddr, size, true);
     }
 }
 
@@ -122,9 +292,6 @@ ISA_EMULATOR_IMPL_CLASS::ISA_EMULATOR_IMPL_CLASS(
     ISA_EMULATOR parent) :
     parent(parent)
 {
-    emulGem5Lock = new unique_lock<std::mutex>(m5mutex);
-    emulGem5Lock->unlock();
-
     HAsimNoteMemoryRead = &HAsimEmulMemoryRead;
     HAsimNoteMemoryWrite = &HAsimEmulMemoryWrite;
 
@@ -135,13 +302,27 @@ ISA_EMULATOR_IMPL_CLASS::ISA_EMULATOR_IMPL_CLASS(
         didInit[c] = false;
         skewCnt[c] = c * SKEW_CONTEXTS;
     }
+
+    // new[] doesn't honor the alignment of REG_SHADOW
+    void *shadow_mem;
+    VERIFYX(posix_memalign(&shadow_mem, alignof(REG_SHADOW),
+                           NumCPUs() * sizeof(REG_SHADOW)) == 0);
+    regCache = static_cast<REG_SHADOW*>(shadow_mem);
+    memset(regCache, 0, NumCPUs() * sizeof(REG_SHADOW));
 }
 
 
 ISA_EMULATOR_IMPL_CLASS::~ISA_EMULATOR_IMPL_CLASS()
 {
+    if (ReportCounters() && (memRefsNoted != 0))
+    {
+        cout << "m5 ISA emulator: " << memRefsNoted << " memory references, "
+             << memNotesSent << " sent to hardware" << endl;
+    }
+
     delete[] didInit;
     delete[] skewCnt;
+    free(regCache);
 }
 
 
@@ -162,7 +343,7 @@ ISA_EMULATOR_IMPL_CLASS::SyncReg(
         M5Cpu(ctxId)->tc->setIntReg(rName.ArchRegNum(), rVal.intReg);
 
         ASSERTX(rName.ArchRegNum() < TheISA::NumIntArchRegs);
-        intRegCache[rName.ArchRegNum()] = rVal.intReg;
+        regCache[ctxId].intReg[rName.ArchRegNum()] = rVal.intReg;
     }
 
     if (rName.IsFPReg())
@@ -170,7 +351,7 @@ ISA_EMULATOR_IMPL_CLASS::SyncReg(
         M5Cpu(ctxId)->tc->setFloatReg(rName.FPRegNum(), rVal.fpReg);
 
         ASSERTX(rName.FPRegNum() < TheISA::NumFloatArchRegs);
-        fpRegCache[rName.FPRegNum()] = rVal.fpReg;
+        regCache[ctxId].fpReg[rName.FPRegNum()] = rVal.fpReg;
     }
 }
 
@@ -182,7 +363,11 @@ ISA_EMULATOR_IMPL_CLASS::Emulate(
     ISA_INSTRUCTION inst,
     FUNCP_VADDR *newPC)
 {
-    unique_lock<std::mutex> isa_emul_lock(emulMutex);
+    unique_lock<std::mutex> isa_emul_lock(emulMutex, std::defer_lock);
+    if (! ParallelContexts())
+    {
+        isa_emul_lock.lock();
+    }
 
     if (! didInit[ctxId])
     {
@@ -239,16 +424,104 @@ ISA_EMULATOR_IMPL_CLASS::Emulate(
     // Set the m5 state and emulate a tick.  The code below is derived from
     // m5's AtomicSimpleCPU::tick()
     //
-    emulGem5Lock->lock();
+    unique_lock<std::mutex> gem5_lock(CtxMutex(ctxId), std::defer_lock);
+    LockCounted(gem5_lock);
+    emulGem5Lock = &gem5_lock;
+
     AtomicSimpleCPU *cpu = M5Cpu(ctxId);
 
+    curEventQueue(mainEventQueue[0]);
+
+    // Registers written from here on are returned to the hardware
+    cpu->thread->clearRegsDirty();
+
+    // Start watching memory
+    StartMemoryWatch(ctxId);
+
+    TheISA::PCState branchTarget;
+    bool isBranch = ExecuteInst(ctxId, cpu, pc, inst, branchTarget);
+
+    // Stop watching memory and send deferred invalidations
+    inEmulation = false;
+    emulMemNotes->Flush();
+
+    //
+    // Update registers
+    //
+    SendRegUpdates(ctxId, false);
+
+    if (isBranch)
+    {
+        Addr cur_pc = cpu->tc->pcState().pc();
+        if (cur_pc == branchTarget.pc())
+        {
+            *newPC = cur_pc;
+        }
+        else
+        {
+            *newPC = 0;
+            isBranch = false;
+        }
+    }
+
+    if (cpu->tc->exitCalled())
+    {
+        return (cpu->tc->exitCode() == 0) ? ISA_EMULATOR_EXIT_OK : ISA_EMULATOR_EXIT_FAIL;
+    }
+
+    if (cpu->tc->status() == ThreadContext::Halted)
+    {
+        // Emulation caused the thread to halt.  Branch to 0 (the normal startup
+        // location) and reset the context's state.
+        *newPC = 0;
+        isBranch = true;
+        didInit[ctxId] = false;
+    }
+
+    return isBranch ? ISA_EMULATOR_BRANCH : ISA_EMULATOR_NORMAL;
+}
+
+
+//
+// Begin watching memory references made by m5 on behalf of a context.
+//
+void
+ISA_EMULATOR_IMPL_CLASS::StartMemoryWatch(
+    CONTEXT_ID ctxId)
+{
+    if (emulMemNotes == NULL)
+    {
+        emulMemNotes = new EMUL_MEM_NOTES();
+    }
+
+    inEmulation = true;
+    emulationMayRefMemory = true;
+
+    emulationCtxId = ctxId;
+}
+
+
+//
+// Execute one instruction at pc in m5.  The code is derived from m5's
+// AtomicSimpleCPU::tick().  The caller holds the context's m5 lock.
+// Returns true if the instruction is a control instruction, with its
+// target in branchTarget.  The instruction is counted in the CPU's
+// SimPoint basic block vectors when simpoint_profile is set.
+//
+bool
+ISA_EMULATOR_IMPL_CLASS::ExecuteInst(
+    CONTEXT_ID ctxId,
+    AtomicSimpleCPU *cpu,
+    FUNCP_VADDR pc,
+    ISA_INSTRUCTION inst,
+    TheISA::PCState &branchTarget)
+{
     // m5 better not be in the middle of an instruction
     VERIFYX(! cpu->curMacroStaticInst);
 
     //
     // Set the machine state and execute the instruction
     //
-    curEventQueue(mainEventQueue[0]);
     TheISA::PCState new_pc = cpu->tc->pcState();
     new_pc.set(pc);
     cpu->tc->pcState(new_pc);
@@ -258,16 +531,21 @@ ISA_EMULATOR_IMPL_CLASS::Emulate(
 
     VERIFYX(cpu->curStaticInst);
 
-    // Start watching memory
-    inEmulation = true;
-    emulationMayRefMemory = true;
-
-    emulationCtxId = ctxId;
+    //
+    // Syscalls may reach m5 state shared by all contexts, e.g. the main
+    // event queue through exitSimLoop().  Contexts holding only a private
+    // lock also take m5mutex for them.
+    //
+    unique_lock<std::mutex> syscall_lock(m5mutex, std::defer_lock);
+    if (cpu->curStaticInst->isSyscall() && (&CtxMutex(ctxId) != &m5mutex))
+    {
+        LockCounted(syscall_lock);
+        emulSyscallLock = &syscall_lock;
+    }
 
     //
     // Is the instruction a branch?
     //
-    TheISA::PCState branchTarget;
     bool isBranch = cpu->curStaticInst->isControl();
     if (isBranch)
     {
@@ -288,78 +566,15 @@ ISA_EMULATOR_IMPL_CLASS::Emulate(
     }
     while (fault != NoFault);
 
+    cpu->profileSimPoint(pc, isBranch);
+
     cpu->postExecute();
     VERIFYX(! cpu->stayAtPC);
 
     cpu->advancePC(fault);
 
-    // Stop watching memory
-    inEmulation = false;
-
-    //
-    // Update registers
-    //
-    for (int r = TheISA::NumFloatArchRegs - 1; r >= 0 ; r--)
-    {
-        ISA_REG_INDEX_CLASS rName;
-        rName.SetFPReg(r);
-        FUNCP_FP_REG rVal = M5Cpu(ctxId)->tc->readFloatReg(r);
-        if (fpRegCache[r] != rVal)
-        {
-            FUNCP_REG v;
-            v.fpReg = rVal;
-            parent->UpdateRegister(ctxId, rName, v);
-            fpRegCache[r] = rVal;
-        }
-    }
-
-    // We loop backwards because the protocol requires integer r0 to
-    // be sent last.
-    for (int r = TheISA::NumIntArchRegs - 1; r >= 0 ; r--)
-    {
-        ISA_REG_INDEX_CLASS rName;
-        rName.SetArchReg(r);
-        FUNCP_INT_REG rVal = M5Cpu(ctxId)->tc->readIntReg(r);
-        if ((intRegCache[r] != rVal) || (r == 0))
-        {
-            FUNCP_REG v;
-            v.intReg = rVal;
-            parent->UpdateRegister(ctxId, rName, v);
-            intRegCache[r] = rVal;
-        }
-    }
-
-    if (isBranch)
-    {
-        Addr cur_pc = cpu->tc->pcState().pc();
-        if (cur_pc == branchTarget.pc())
-        {
-            *newPC = cur_pc;
-        }
-        else
-        {
-            *newPC = 0;
-            isBranch = false;
-        }
-    }
-
-    if (cpu->tc->exitCalled())
-    {
-        emulGem5Lock->unlock();
-        return (cpu->tc->exitCode() == 0) ? ISA_EMULATOR_EXIT_OK : ISA_EMULATOR_EXIT_FAIL;
-    }
-
-    if (cpu->tc->status() == ThreadContext::Halted)
-    {
-        // Emulation caused the thread to halt.  Branch to 0 (the normal startup
-        // location) and reset the context's state.
-        *newPC = 0;
-        isBranch = true;
-        didInit[ctxId] = false;
-    }
-
-    emulGem5Lock->unlock();
-    return isBranch ? ISA_EMULATOR_BRANCH : ISA_EMULATOR_NORMAL;
+    emulSyscallLock = NULL;
+    return isBranch;
 }
 
 
@@ -430,28 +645,7 @@ ISA_EMULATOR_IMPL_CLASS::StartProgram(
             // Context is ready to start.
             // Now set all the start register values and jump to the right PC.
             //
-
-            for (int r = TheISA::NumFloatArchRegs - 1; r >= 0 ; r--)
-            {
-                ISA_REG_INDEX_CLASS rName;
-                FUNCP_REG rVal;
-                rName.SetFPReg(r);
-                rVal.fpReg = M5Cpu(ctxId)->tc->readFloatReg(r);
-                parent->UpdateRegister(ctxId, rName, rVal);
-                fpRegCache[r] = rVal.fpReg;
-            }
-
-            // We loop backwards because the protocol requires integer r0 to
-            // be sent last.
-            for (int r = TheISA::NumIntArchRegs - 1; r >= 0 ; r--)
-            {
-                ISA_REG_INDEX_CLASS rName;
-                FUNCP_REG rVal;
-                rName.SetArchReg(r);
-                rVal.intReg = M5Cpu(ctxId)->tc->readIntReg(r);
-                parent->UpdateRegister(ctxId, rName, rVal);
-                intRegCache[r] = rVal.intReg;
-            }
+            SendRegUpdates(ctxId, true);
 
             ASIMWARNING("Activating Context: " << (int) ctxId << endl);
             return ISA_EMULATOR_BRANCH;
@@ -476,6 +670,66 @@ ISA_EMULATOR_IMPL_CLASS::StartProgram(
 }
 
 
+//
+// SendRegUpdates --
+//     Return register state to the hardware.  m5 tracks the registers
+//     written since the dirty bits were last cleared, so only those are
+//     compared against the values last sent.  Changed values are sent
+//     one message per register, FP registers first, then integer
+//     registers, each in descending order.  The protocol requires that
+//     integer r0 always be sent and be last.
+//
+//     Sending all the updates of an instruction in one message (a mask
+//     of the registers present and the packed values) needs a new method
+//     in the ISA emulator RRR service and its hardware client, which are
+//     not part of this tree.
+//
+void
+ISA_EMULATOR_IMPL_CLASS::SendRegUpdates(
+    CONTEXT_ID ctxId,
+    bool sendAll)
+{
+    SimpleThread *thread = M5Cpu(ctxId)->thread;
+    REG_SHADOW *shadow = &regCache[ctxId];
+
+    for (int r = TheISA::NumFloatArchRegs - 1; r >= 0 ; r--)
+    {
+        if (sendAll || thread->floatRegDirty(r))
+        {
+            FUNCP_FP_REG rVal = thread->readFloatReg(r);
+            if (sendAll || (shadow->fpReg[r] != rVal))
+            {
+                ISA_REG_INDEX_CLASS rName;
+                FUNCP_REG v;
+                rName.SetFPReg(r);
+                v.fpReg = rVal;
+                parent->UpdateRegister(ctxId, rName, v);
+                shadow->fpReg[r] = rVal;
+            }
+        }
+    }
+
+    for (int r = TheISA::NumIntArchRegs - 1; r >= 0 ; r--)
+    {
+        if (sendAll || (r == 0) || thread->intRegDirty(r))
+        {
+            FUNCP_INT_REG rVal = thread->readIntReg(r);
+            if (sendAll || (r == 0) || (shadow->intReg[r] != rVal))
+            {
+                ISA_REG_INDEX_CLASS rName;
+                FUNCP_REG v;
+                rName.SetArchReg(r);
+                v.intReg = rVal;
+                parent->UpdateRegister(ctxId, rName, v);
+                shadow->intReg[r] = rVal;
+            }
+        }
+    }
+
+    thread->clearRegsDirty();
+}
+
+
 // ========================================================================
 //
 // m5 Operation-Level Emulation...
@@ -503,8 +757,15 @@ ISA_REGOP_EMULATOR_IMPL_CLASS::EmulateRegOp(
     ISA_REG_INDEX_CLASS rNameSrc1,
     ISA_REG_INDEX_CLASS rNameDst)
 {
-    unique_lock<std::mutex> isa_emul_lock(emulMutex);
-    emulGem5Lock->lock();
+    unique_lock<std::mutex> isa_emul_lock(emulMutex, std::defer_lock);
+    if (! ParallelContexts())
+    {
+        isa_emul_lock.lock();
+    }
+
+    unique_lock<std::mutex> gem5_lock(CtxMutex(ctxId), std::defer_lock);
+    LockCounted(gem5_lock);
+    emulGem5Lock = &gem5_lock;
 
     if (rNameSrc0.IsArchReg())
     {
@@ -586,8 +847,6 @@ ISA_REGOP_EMULATOR_IMPL_CLASS::EmulateRegOp(
         ASIMERROR("Unexpected register type");
     }
 
-    emulGem5Lock->unlock();
-
     return rVal;
 }
 
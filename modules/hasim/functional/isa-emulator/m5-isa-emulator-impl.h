@@ -67,12 +67,36 @@ class ISA_EMULATOR_IMPL_CLASS : public M5_HASIM_BASE_CLASS
         FUNCP_VADDR curPC,
         FUNCP_VADDR *newPC);
 
+    // Send registers modified since the last update (or all registers
+    // when sendAll is set) to the hardware.
+    void SendRegUpdates(CONTEXT_ID ctxId, bool sendAll);
+
+    void StartMemoryWatch(CONTEXT_ID ctxId);
+
+    bool ExecuteInst(
+        CONTEXT_ID ctxId,
+        AtomicSimpleCPU *cpu,
+        FUNCP_VADDR pc,
+        ISA_INSTRUCTION inst,
+        TheISA::PCState &branchTarget);
+
     ISA_EMULATOR parent;
     bool *didInit;      // Initialized bit (one per hardware context)
     UINT32 *skewCnt;    // Counter used during skewed start
 
-    FUNCP_INT_REG intRegCache[TheISA::NumIntArchRegs];
-    FUNCP_FP_REG fpRegCache[TheISA::NumFloatArchRegs];
+    //
+    // Register values last sent to the hardware, one set per context.
+    // Each set is aligned to a cache line so contexts emulated in parallel
+    // don't share lines.
+    //
+    struct REG_SHADOW
+    {
+        FUNCP_INT_REG intReg[TheISA::NumIntArchRegs];
+        FUNCP_FP_REG fpReg[TheISA::NumFloatArchRegs];
+    }
+    __attribute__((aligned(64)));
+
+    REG_SHADOW *regCache;
 };
 
 
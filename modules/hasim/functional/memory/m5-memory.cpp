@@ -45,11 +45,21 @@
 
 // m5 includes
 #include "base/chunk_generator.hh"
+#include "mem/abstract_mem.hh"
+#include "mem/physical.hh"
 #include "sim/faults.hh"
 #include "sim/eventq.hh"
+#include "sim/system.hh"
 
+extern void (*HAsimNoteMemoryRead)(Addr paddr, uint64_t size);
+extern void (*HAsimNoteMemoryWrite)(Addr paddr, uint64_t size);
 
-FUNCP_SIMULATED_MEMORY_CLASS::FUNCP_SIMULATED_MEMORY_CLASS()
+
+FUNCP_SIMULATED_MEMORY_CLASS::FUNCP_SIMULATED_MEMORY_CLASS() :
+    ringHead(0),
+    ringDone(0),
+    ringTail(0),
+    ringStop(false)
 {
     SetTraceableName("funcp_memory_m5");
 
@@ -74,11 +84,69 @@ FUNCP_SIMULATED_MEMORY_CLASS::FUNCP_SIMULATED_MEMORY_CLASS()
     }
 
     guard_page &= TheISA::PageMask;
+
+    //
+    // Record the host backing store of simple (non-interleaved) memories
+    // so Read() and Write() can copy data directly.  Everything else,
+    // including I/O space, goes through memPort.
+    //
+    const std::vector<AbstractMemory*> &mems =
+        M5Cpu(0)->system->getPhysMem().getMemories();
+
+    for (std::vector<AbstractMemory*>::const_iterator m = mems.begin();
+         m != mems.end();
+         ++m)
+    {
+        AddrRange range = (*m)->getAddrRange();
+        if (! (*m)->isNull() && ! range.interleaved())
+        {
+            HOST_MEM_RANGE r;
+            r.start = range.start();
+            r.end = range.start() + range.size() - 1;
+            r.host = (*m)->toHostAddr(range.start());
+            hostMem.push_back(r);
+        }
+    }
+
+    //
+    // Translation caches are kept coherent by the process page tables.
+    //
+    vtopCache = new FUNCP_VTOP_CACHE_CLASS[NumCPUs()];
+    for (UINT32 c = 0; c < NumCPUs(); c++)
+    {
+        M5Cpu(c)->tc->getProcessPtr()->pTable->addObserver(&vtopCache[c]);
+    }
 }
 
 
 FUNCP_SIMULATED_MEMORY_CLASS::~FUNCP_SIMULATED_MEMORY_CLASS()
 {
+    if (ringWorker.joinable())
+    {
+        {
+            unique_lock<std::mutex> lock(ringMutex);
+            ringStop = true;
+        }
+        ringWork.notify_one();
+        ringWorker.join();
+    }
+
+    for (UINT32 c = 0; c < NumCPUs(); c++)
+    {
+        UINT64 hits = vtopCache[c].Hits();
+        UINT64 misses = vtopCache[c].Misses();
+        if (ReportCounters() && (hits + misses != 0))
+        {
+            cout << "funcp_memory_m5: context " << c << " VtoP cache "
+                 << hits << " hits, " << misses << " misses" << endl;
+        }
+    }
+
+    for (UINT32 c = 0; c < NumCPUs(); c++)
+    {
+        M5Cpu(c)->tc->getProcessPtr()->pTable->removeObserver(&vtopCache[c]);
+    }
+    delete[] vtopCache;
 }
 
 
@@ -119,9 +187,31 @@ FUNCP_SIMULATED_MEMORY_CLASS::BlobHelper(
     MemCmd cmd,
     bool isSpeculative)
 {
-    bool success = true;
+    // In parallel mode m5 physical memory is protected by HAsimMemoryMutex
+    // inside m5 and no global lock is required.
+    unique_lock<std::mutex> isa_emul_lock(m5mutex, std::defer_lock);
+    if (! ParallelContexts())
+    {
+        LockCounted(isa_emul_lock);
+    }
 
-    unique_lock<std::mutex> isa_emul_lock(m5mutex);
+    return BlobAccess(paddr, p, size, cmd, isSpeculative);
+}
+
+
+//
+// BlobAccess is the body of BlobHelper.  The caller holds any required
+// m5 lock.
+//
+bool
+FUNCP_SIMULATED_MEMORY_CLASS::BlobAccess(
+    Addr paddr,
+    uint8_t *p,
+    int size,
+    MemCmd cmd,
+    bool isSpeculative)
+{
+    bool success = true;
 
     if ((paddr & TheISA::PageMask) == guard_page)
     {
@@ -143,6 +233,34 @@ FUNCP_SIMULATED_MEMORY_CLASS::BlobHelper(
     for (ChunkGenerator gen(paddr, size, TheISA::PageBytes);
          ! gen.done(); gen.next())
     {
+        //
+        // Fast path:  copy directly to or from m5's backing store.  HAsim
+        // is notified exactly as m5's functionalAccess() would.
+        //
+        uint8_t *host = HostAddr(gen.addr(), gen.size());
+        if (host != NULL)
+        {
+            if (cmd == MemCmd::WriteReq)
+            {
+                if (HAsimNoteMemoryWrite != NULL)
+                {
+                    HAsimNoteMemoryWrite(gen.addr(), gen.size());
+                }
+                memcpy(host, p, gen.size());
+            }
+            else
+            {
+                if (HAsimNoteMemoryRead != NULL)
+                {
+                    HAsimNoteMemoryRead(gen.addr(), gen.size());
+                }
+                memcpy(p, host, gen.size());
+            }
+
+            p += gen.size();
+            continue;
+        }
+
         curEventQueue(mainEventQueue[0]);
         req.setPhys(gen.addr(), gen.size(), 0, Request::funcMasterId);
         Packet pkt(&req, cmd);
@@ -165,6 +283,29 @@ FUNCP_SIMULATED_MEMORY_CLASS::BlobHelper(
 }
 
 
+//
+// Host address of a physical range if it is entirely within one directly
+// accessible m5 memory.  NULL otherwise.
+//
+uint8_t *
+FUNCP_SIMULATED_MEMORY_CLASS::HostAddr(
+    Addr paddr,
+    int size) const
+{
+    for (std::vector<HOST_MEM_RANGE>::const_iterator r = hostMem.begin();
+         r != hostMem.end();
+         ++r)
+    {
+        if ((paddr >= r->start) && (paddr + size - 1 <= r->end))
+        {
+            return r->host + (paddr - r->start);
+        }
+    }
+
+    return NULL;
+}
+
+
 //
 // Virtual to physical mapping
 //
@@ -174,26 +315,67 @@ FUNCP_SIMULATED_MEMORY_CLASS::VtoP(
     UINT64 va,
     bool allocOnFault)
 {
-    Addr paddr;
+    FUNCP_MEM_VTOP_RESP resp;
+    if (VtoPFast(ctxId, va, resp))
+    {
+        return resp;
+    }
 
-    static const char *dfault = NULL;
-    static const char *dtb_miss_single = NULL;
+    unique_lock<std::mutex> isa_emul_lock(CtxMutex(ctxId), std::defer_lock);
+    LockCounted(isa_emul_lock);
+
+    return VtoPSlow(ctxId, va, allocOnFault);
+}
 
-    unique_lock<std::mutex> isa_emul_lock(m5mutex);
+
+//
+// Translations that need no m5 lock:  the guard page and hits in the
+// context's translation cache.
+//
+bool
+FUNCP_SIMULATED_MEMORY_CLASS::VtoPFast(
+    CONTEXT_ID ctxId,
+    UINT64 va,
+    FUNCP_MEM_VTOP_RESP &resp)
+{
+    Addr paddr;
 
     if ((va & TheISA::PageMask) == 0)
     {
-        FUNCP_MEM_VTOP_RESP resp;
         resp.pa = guard_page | (va & TheISA::PageMask);
         resp.pageFault = false;
         resp.ioSpace = false;
-        return resp;
+        return true;
     }
 
+    Addr va_page = roundDown(va, TheISA::VMPageSize);
+    if (vtopCache[ctxId].Lookup(va_page, paddr))
+    {
+        resp.pa = paddr;
+        resp.pageFault = false;
+        resp.ioSpace = false;
+        return true;
+    }
+
+    return false;
+}
+
+
+//
+// Page table walk and allocation.  The caller holds the context's m5 lock.
+//
+FUNCP_MEM_VTOP_RESP
+FUNCP_SIMULATED_MEMORY_CLASS::VtoPSlow(
+    CONTEXT_ID ctxId,
+    UINT64 va,
+    bool allocOnFault)
+{
+    Addr paddr;
+    Addr va_page = roundDown(va, TheISA::VMPageSize);
+
     Process *proc = M5Cpu(ctxId)->tc->getProcessPtr();
     PageTable *pTable = proc->pTable;
 
-    Addr va_page = roundDown(va, TheISA::VMPageSize);
     if (! pTable->translate(va_page, paddr))
     {
         T1("\tfuncp_memory_m5: VtoP no mapping VA " << fmt_va(va_page));
@@ -216,9 +398,256 @@ FUNCP_SIMULATED_MEMORY_CLASS::VtoP(
         T1("\tfuncp_memory_m5: VtoP alloc VA " << fmt_va(va_page) << " to PA " << fmt_va(paddr));
     }
 
+    vtopCache[ctxId].Fill(va_page, paddr);
+
     FUNCP_MEM_VTOP_RESP resp;
     resp.pa = paddr;
     resp.pageFault = false;
     resp.ioSpace = false;
     return resp;
 }
+
+
+// ========================================================================
+//
+// Asynchronous requests
+//
+// ========================================================================
+
+UINT32
+FUNCP_SIMULATED_MEMORY_CLASS::SubmitRequests(
+    const FUNCP_MEM_REQ *reqs,
+    UINT32 nReqs)
+{
+    UINT32 n = 0;
+
+    {
+        unique_lock<std::mutex> lock(ringMutex);
+
+        // The worker is started by the first request
+        if (! ringWorker.joinable())
+        {
+            ringWorker = std::thread(&FUNCP_SIMULATED_MEMORY_CLASS::RingWorkerLoop, this);
+        }
+
+        while ((n < nReqs) && (ringTail - ringHead < MEM_REQ_RING_SIZE))
+        {
+            ring[ringTail % MEM_REQ_RING_SIZE].req = reqs[n];
+            ringTail += 1;
+            n += 1;
+        }
+    }
+
+    if (n != 0)
+    {
+        ringWork.notify_one();
+    }
+
+    return n;
+}
+
+
+UINT32
+FUNCP_SIMULATED_MEMORY_CLASS::CollectCompletions(
+    FUNCP_MEM_COMPLETION *done,
+    UINT32 maxDone,
+    UINT32 minDone)
+{
+    unique_lock<std::mutex> lock(ringMutex);
+
+    VERIFY(minDone <= ringTail - ringHead,
+           "CollectCompletions would wait for requests never submitted");
+
+    while (ringDone - ringHead < minDone)
+    {
+        ringComplete.wait(lock);
+    }
+
+    UINT32 n = 0;
+    while ((n < maxDone) && (ringHead != ringDone))
+    {
+        done[n] = ring[ringHead % MEM_REQ_RING_SIZE].resp;
+        ringHead += 1;
+        n += 1;
+    }
+
+    return n;
+}
+
+
+//
+// The worker services all requests pending when it wakes as a single
+// batch.  Slots in the batch are not touched by the submitter or the
+// collector, so the ring lock is not held while servicing them.
+//
+void
+FUNCP_SIMULATED_MEMORY_CLASS::RingWorkerLoop()
+{
+    unique_lock<std::mutex> lock(ringMutex);
+
+    while (true)
+    {
+        while (! ringStop && (ringDone == ringTail))
+        {
+            ringWork.wait(lock);
+        }
+
+        if (ringDone == ringTail)
+        {
+            // Stopped and nothing left to do
+            return;
+        }
+
+        UINT64 first = ringDone;
+        UINT64 last = ringTail;
+
+        lock.unlock();
+        ServiceRequests(first, last);
+        lock.lock();
+
+        ringDone = last;
+        ringComplete.notify_all();
+    }
+}
+
+
+void
+FUNCP_SIMULATED_MEMORY_CLASS::ServiceRequests(
+    UINT64 first,
+    UINT64 last)
+{
+    //
+    // Acquire the global m5 lock once for the whole batch.  In parallel
+    // mode memory needs no global lock and VtoP uses per-context locks.
+    //
+    unique_lock<std::mutex> m5_lock(m5mutex, std::defer_lock);
+    if (! ParallelContexts())
+    {
+        LockCounted(m5_lock);
+    }
+
+    for (UINT64 i = first; i != last; i++)
+    {
+        const FUNCP_MEM_REQ &req = ring[i % MEM_REQ_RING_SIZE].req;
+        FUNCP_MEM_COMPLETION &resp = ring[i % MEM_REQ_RING_SIZE].resp;
+
+        resp.tag = req.tag;
+        resp.success = true;
+
+        switch (req.op)
+        {
+          case FUNCP_MEM_OP_READ:
+            ASSERTX(req.size > 0);
+            resp.success = BlobAccess(req.addr, (uint8_t*)req.data, req.size,
+                                      MemCmd::ReadReq, req.isSpeculative);
+            break;
+
+          case FUNCP_MEM_OP_WRITE:
+            ASSERTX(req.size > 0);
+            BlobAccess(req.addr, (uint8_t*)req.data, req.size,
+                       MemCmd::WriteReq, false);
+            break;
+
+          case FUNCP_MEM_OP_VTOP:
+            if (ParallelContexts())
+            {
+                resp.vtop = VtoP(req.ctxId, req.addr, req.allocOnFault);
+            }
+            else if (! VtoPFast(req.ctxId, req.addr, resp.vtop))
+            {
+                resp.vtop = VtoPSlow(req.ctxId, req.addr, req.allocOnFault);
+            }
+            break;
+
+          default:
+            ASIMERROR("Unexpected asynchronous memory operation " << int(req.op));
+        }
+    }
+}
+
+
+// ========================================================================
+//
+// VtoP translation cache
+//
+// ========================================================================
+
+FUNCP_VTOP_CACHE_CLASS::FUNCP_VTOP_CACHE_CLASS() :
+    hits(0),
+    misses(0)
+{
+    ASSERTX((VTOP_CACHE_ENTRIES & (VTOP_CACHE_ENTRIES - 1)) == 0);
+
+    for (UINT32 i = 0; i < VTOP_CACHE_ENTRIES; i++)
+    {
+        entries[i].seq = 0;
+        entries[i].vaPage = invalidVA;
+        entries[i].paPage = 0;
+    }
+}
+
+
+bool
+FUNCP_VTOP_CACHE_CLASS::Lookup(
+    Addr vaPage,
+    Addr &paPage)
+{
+    ENTRY &e = Entry(vaPage);
+
+    UINT32 seq = e.seq.load(std::memory_order_acquire);
+    if (! (seq & 1) && (e.vaPage.load(std::memory_order_relaxed) == vaPage))
+    {
+        Addr pa = e.paPage.load(std::memory_order_relaxed);
+
+        // The entry is valid only if no update started during the read
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.seq.load(std::memory_order_relaxed) == seq)
+        {
+            paPage = pa;
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+
+void
+FUNCP_VTOP_CACHE_CLASS::Fill(
+    Addr vaPage,
+    Addr paPage)
+{
+    Update(Entry(vaPage), vaPage, paPage);
+}
+
+
+void
+FUNCP_VTOP_CACHE_CLASS::invalidatePage(
+    Addr vaddr)
+{
+    ENTRY &e = Entry(vaddr);
+    if (e.vaPage.load(std::memory_order_relaxed) == vaddr)
+    {
+        Update(e, invalidVA, 0);
+    }
+}
+
+
+void
+FUNCP_VTOP_CACHE_CLASS::Update(
+    ENTRY &e,
+    Addr vaPage,
+    Addr paPage)
+{
+    UINT32 seq = e.seq.load(std::memory_order_relaxed);
+
+    e.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    e.vaPage.store(vaPage, std::memory_order_relaxed);
+    e.paPage.store(paPage, std::memory_order_relaxed);
+
+    e.seq.store(seq + 2, std::memory_order_release);
+}
@@ -38,16 +38,24 @@
 #ifndef __HASIM_M5_MEMORY__
 #define __HASIM_M5_MEMORY__
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "asim/syntax.h"
 #include "asim/provides/m5_hasim_base.h"
 #include "asim/provides/funcp_base_types.h"
 
 // m5 includes
 #include "cpu/base.hh"
+#include "mem/page_table.hh"
 #include "mem/port.hh"
 #include "sim/process.hh"
 
 typedef class FUNCP_SIMULATED_MEMORY_CLASS *FUNCP_SIMULATED_MEMORY;
+typedef class FUNCP_VTOP_CACHE_CLASS *FUNCP_VTOP_CACHE;
 
 // Response from VtoP
 struct FUNCP_MEM_VTOP_RESP
@@ -57,6 +65,85 @@ struct FUNCP_MEM_VTOP_RESP
     bool ioSpace;      // Reference is to uncacheable I/O space
 };
 
+//
+// Asynchronous memory operations.  Requests are submitted in batches,
+// serviced in order by a worker thread and their completions collected
+// in bulk.
+//
+enum FUNCP_MEM_OP
+{
+    FUNCP_MEM_OP_READ,
+    FUNCP_MEM_OP_WRITE,
+    FUNCP_MEM_OP_VTOP
+};
+
+struct FUNCP_MEM_REQ
+{
+    FUNCP_MEM_OP op;
+    UINT64 tag;             // Returned unchanged in the completion
+    CONTEXT_ID ctxId;       // VtoP only
+    UINT64 addr;            // PA for read/write, VA for VtoP
+    UINT64 size;            // Read/write only
+    bool isSpeculative;     // Read only
+    bool allocOnFault;      // VtoP only
+    void *data;             // Read destination or write source.  Owned by
+                            // the caller until the request completes.
+};
+
+struct FUNCP_MEM_COMPLETION
+{
+    UINT64 tag;
+    bool success;                 // Read/write
+    FUNCP_MEM_VTOP_RESP vtop;     // VtoP
+};
+
+//
+// Direct-mapped cache of a context's VA page to PA page translations, in
+// front of the m5 page table.  Lookups are lock free.  Fills happen with
+// the context's m5 lock held and invalidations come from the page table
+// (also under the context's lock) so there is a single writer at a time.
+// Each entry is protected by a sequence number that is odd while the
+// entry is being updated.
+//
+class FUNCP_VTOP_CACHE_CLASS : public PageTableObserver
+{
+  public:
+    FUNCP_VTOP_CACHE_CLASS();
+    ~FUNCP_VTOP_CACHE_CLASS() {};
+
+    bool Lookup(Addr vaPage, Addr &paPage);
+    void Fill(Addr vaPage, Addr paPage);
+
+    // PageTableObserver
+    void invalidatePage(Addr vaddr);
+
+    UINT64 Hits() const { return hits; };
+    UINT64 Misses() const { return misses; };
+
+  private:
+    struct ENTRY
+    {
+        std::atomic<UINT32> seq;
+        std::atomic<Addr> vaPage;
+        std::atomic<Addr> paPage;
+    };
+
+    static const Addr invalidVA = ~Addr(0);
+
+    ENTRY entries[VTOP_CACHE_ENTRIES];
+
+    std::atomic<UINT64> hits;
+    std::atomic<UINT64> misses;
+
+    ENTRY &Entry(Addr vaPage)
+    {
+        return entries[(vaPage >> TheISA::LogVMPageSize) & (VTOP_CACHE_ENTRIES - 1)];
+    };
+
+    void Update(ENTRY &e, Addr vaPage, Addr paPage);
+};
+
+
 class FUNCP_SIMULATED_MEMORY_CLASS : public M5_HASIM_BASE_CLASS,
                                      public TRACEABLE_CLASS
 {
@@ -73,13 +160,71 @@ class FUNCP_SIMULATED_MEMORY_CLASS : public M5_HASIM_BASE_CLASS,
 
     FUNCP_MEM_VTOP_RESP VtoP(CONTEXT_ID ctxId, UINT64 va, bool allocOnFault);
 
+    //
+    // Asynchronous interface.  SubmitRequests() queues as many requests as
+    // there is room for and returns the number accepted.  It never blocks.
+    // CollectCompletions() returns up to maxDone completions in submission
+    // order, waiting until at least minDone are available.
+    //
+    UINT32 SubmitRequests(const FUNCP_MEM_REQ *reqs, UINT32 nReqs);
+    UINT32 CollectCompletions(FUNCP_MEM_COMPLETION *done,
+                              UINT32 maxDone,
+                              UINT32 minDone);
+
   private:
     MasterPort *memPort;
     Format fmt_va;
 
     Addr guard_page;        // Mapped to virtual address 0
 
+    FUNCP_VTOP_CACHE vtopCache;     // One translation cache per context
+
+    //
+    // Host backing store of m5 memories that may be accessed directly,
+    // bypassing the port hierarchy.
+    //
+    struct HOST_MEM_RANGE
+    {
+        Addr start;
+        Addr end;           // Inclusive
+        uint8_t *host;      // Host address of start
+    };
+
+    std::vector<HOST_MEM_RANGE> hostMem;
+
+    uint8_t *HostAddr(Addr paddr, int size) const;
+
     bool BlobHelper(Addr paddr, uint8_t *p, int size, MemCmd cmd, bool isSpeculative);
+    bool BlobAccess(Addr paddr, uint8_t *p, int size, MemCmd cmd, bool isSpeculative);
+
+    bool VtoPFast(CONTEXT_ID ctxId, UINT64 va, FUNCP_MEM_VTOP_RESP &resp);
+    FUNCP_MEM_VTOP_RESP VtoPSlow(CONTEXT_ID ctxId, UINT64 va, bool allocOnFault);
+
+    //
+    // Ring of asynchronous requests.  Indices increase monotonically and
+    // are reduced modulo MEM_REQ_RING_SIZE.  Slots in [ringHead, ringDone)
+    // hold completions waiting to be collected, [ringDone, ringTail) hold
+    // requests waiting for the worker.
+    //
+    struct RING_SLOT
+    {
+        FUNCP_MEM_REQ req;
+        FUNCP_MEM_COMPLETION resp;
+    };
+
+    RING_SLOT ring[MEM_REQ_RING_SIZE];
+    UINT64 ringHead;
+    UINT64 ringDone;
+    UINT64 ringTail;
+
+    std::mutex ringMutex;
+    std::condition_variable ringWork;       // Requests submitted
+    std::condition_variable ringComplete;   // Requests completed
+    std::thread ringWorker;
+    bool ringStop;
+
+    void RingWorkerLoop();
+    void ServiceRequests(UINT64 first, UINT64 last);
 };
 
 #endif //  __HASIM_M5_MEMORY__